@@ -0,0 +1,67 @@
+// Per-request cost of N middlewares registered globally versus scoped to one prefix.
+//
+// Each middleware looks up a header, as an auth check would. Requests go through the whole
+// server (parse, route, middleware, handler, response) on one keep-alive connection.
+#include "bench_util.h"
+#include <http_server.h>
+
+static size_t middlewareCalls = 0;
+
+static bool checkToken(HttpRequest &req, HubHttpResponse &response, void *context) {
+    middlewareCalls++;
+    return req.getHeaderView("X-Robot-Token").equals(static_cast<const char*>(context));
+}
+
+struct Cost {
+    double nanos;
+    double calls; // middleware calls per request
+};
+
+// Cost of a request for `path` on a server with `count` middlewares, global or under /api/secure
+static Cost requestCost(size_t count, bool scoped, const char *path) {
+    static char token[] = "6b0d3f2a9c";
+    HttpServer server;
+    server.setKeepAlive(true);
+    for (size_t i = 0; i < count; i++) {
+        if (scoped) {
+            server.use("/api/secure", checkToken, token);
+        } else {
+            server.use(checkToken, token);
+        }
+    }
+    server.on("GET", "/health", [](HttpRequest &req) { return HubHttpResponse(200, "ok"); });
+    server.on("GET", "/api/secure/data", [](HttpRequest &req) { return HubHttpResponse(200, "data"); });
+    server.begin();
+
+    std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: robot\r\nX-Robot-Token: 6b0d3f2a9c\r\n\r\n";
+    std::shared_ptr<MockSocket> socket(new MockSocket());
+    WiFiServer::pending.push_back(WiFiClient(socket));
+    server.tick(); // accept
+    size_t requests = 0;
+    middlewareCalls = 0;
+    Cost cost;
+    cost.nanos = nanosPerCall([&]() {
+        socket->received = request;
+        server.tick();
+        socket->sent.clear();
+        requests++;
+    }, 40.0, 7);
+    cost.calls = static_cast<double>(middlewareCalls) / requests;
+    return cost;
+}
+
+int main() {
+    static const size_t COUNTS[] = { 0, 1, 4, 16 };
+    printf("ns per request (middleware calls per request)\n");
+    printf("%11s %18s %18s %18s\n", "middlewares", "global", "scoped", "scoped, in scope");
+    printf("%11s %18s %18s %18s\n", "", "GET /health", "GET /health", "GET /api/secure/..");
+    for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); c++) {
+        size_t n = COUNTS[c];
+        Cost global = requestCost(n, false, "/health");
+        Cost scoped = requestCost(n, true, "/health");
+        Cost inScope = requestCost(n, true, "/api/secure/data");
+        printf("%11zu %12.0f (%3.0f) %12.0f (%3.0f) %12.0f (%3.0f)\n", n,
+               global.nanos, global.calls, scoped.nanos, scoped.calls, inScope.nanos, inScope.calls);
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// phr_parse_request throughput - build once per scanner (see the Makefile):
+//   bench_parser_bytes  byte loops (PICOHTTPPARSER_DISABLE_SWAR)
+//   bench_parser_swar   word-at-a-time scanning, what the ARM builds use
+//   bench_parser_swar_aligned  the same with aligned loads only (PICOHTTPPARSER_SWAR_ALIGNED, opt-in
+//                       for the ESP32, which uses the byte loops by default)
+//   bench_parser_sse42  SSE4.2 (x86 hosts only)
+//
+// Usage: bench_parser [request files...]   (defaults to request_corpus.h)
+#include "bench_util.h"
+#include "request_corpus.h"
+#include "picohttpparser/picohttpparser.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef SCANNER
+#define SCANNER "?"
+#endif
+
+struct Sample {
+    std::string name;
+    std::string bytes;
+};
+
+// Parse once, returning a digest of what was recognised (must match across scanners)
+static unsigned long parseDigest(const char *buf, size_t len) {
+    const char *method, *path;
+    size_t methodLen, pathLen, numHeaders = 32;
+    int minor;
+    struct phr_header headers[32];
+    int ret = phr_parse_request(buf, len, &method, &methodLen, &path, &pathLen, &minor, headers, &numHeaders, 0);
+    unsigned long digest = static_cast<unsigned long>(ret) * 31 + methodLen * 7 + pathLen;
+    for (size_t i = 0; ret > 0 && i < numHeaders; i++) {
+        digest = digest * 131 + headers[i].name_len * 17 + headers[i].value_len;
+    }
+    return digest;
+}
+
+int main(int argc, char **argv) {
+    std::vector<Sample> samples;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        Sample sample = { argv[i], content.str() };
+        samples.push_back(sample);
+    }
+    if (samples.empty()) {
+        for (size_t i = 0; i < sizeof(REQUEST_CORPUS) / sizeof(REQUEST_CORPUS[0]); i++) {
+            Sample sample = { REQUEST_CORPUS[i][0], REQUEST_CORPUS[i][1] };
+            samples.push_back(sample);
+        }
+    }
+
+    printf("scanner: %s\n", SCANNER);
+    printf("%-20s %8s %12s %10s %18s\n", "request", "bytes", "ns/parse", "MB/s", "digest");
+    // Every request is parsed at each of 8 buffer alignments, as the receive buffer offsets vary
+    static char buffer[64 * 1024 + 8];
+    for (size_t s = 0; s < samples.size(); s++) {
+        const std::string &bytes = samples[s].bytes;
+        size_t len = bytes.size() < sizeof(buffer) - 8 ? bytes.size() : sizeof(buffer) - 8;
+        unsigned long digest = 0;
+        double nanos = 0;
+        for (size_t align = 0; align < 8; align++) {
+            memcpy(buffer + align, bytes.data(), len);
+            digest = digest * 3 + parseDigest(buffer + align, len);
+            nanos += nanosPerCall([&]() { keep(parseDigest(buffer + align, len)); }, 10.0);
+        }
+        nanos /= 8;
+        printf("%-20s %8zu %12.1f %10.1f %18lx\n", samples[s].name.c_str(), len, nanos, len / nanos * 1e3, digest);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Route lookup cost as the route count grows from 10 to 1000.
+//
+// "linear" is the lookup the server used before the segment tree: every registered
+// pattern is tried in turn, and each try splits the request path into a fresh
+// std::vector<String>. "tree" is HttpRouter::find() with its cache disabled, "cached"
+// the same lookup answered from the router's cache of recent paths. "404 scan" cycles
+// through more unknown paths than the cache holds, so every cached lookup misses.
+#include "bench_util.h"
+#include <http_server.h>
+#include <map>
+#include <vector>
+
+struct LinearRoute {
+    String method;
+    std::vector<String> segments;
+};
+
+static std::vector<String> splitSegments(const String &path) {
+    std::vector<String> segments;
+    int start = 0;
+    while (start < static_cast<int>(path.length())) {
+        int idx = path.indexOf('/', start);
+        if (idx == -1) idx = path.length();
+        String segment = path.substring(start, idx);
+        if (segment.length() > 0) segments.push_back(segment);
+        start = idx + 1;
+    }
+    return segments;
+}
+
+// The pre-tree matchPattern(), applied to every route until one matches
+static int linearFind(const std::vector<LinearRoute> &routes, const String &method, const String &path,
+                      std::map<String, String> &params) {
+    for (size_t r = 0; r < routes.size(); r++) {
+        const LinearRoute &route = routes[r];
+        if (!route.method.equalsIgnoreCase(method)) continue;
+        std::vector<String> pathSegs = splitSegments(path);
+        if (pathSegs.size() != route.segments.size()) continue;
+        bool match = true;
+        for (size_t i = 0; i < route.segments.size() && match; i++) {
+            if (route.segments[i].startsWith(":")) {
+                params[route.segments[i].substring(1)] = pathSegs[i];
+            } else if (route.segments[i] != pathSegs[i]) {
+                match = false;
+            }
+        }
+        if (match) return static_cast<int>(r);
+    }
+    return -1;
+}
+
+// Route i of n: a mix of static and :param routes spread over groups, GET and POST
+static void routeFor(size_t i, String &method, String &pattern) {
+    method = i % 4 == 3 ? "POST" : "GET";
+    pattern = "/api/group" + String(static_cast<unsigned long>(i / 10)) + "/";
+    if (i % 3 == 0) {
+        pattern += ":id/detail" + String(static_cast<unsigned long>(i));
+    } else {
+        pattern += "item" + String(static_cast<unsigned long>(i));
+    }
+}
+
+// Highest route index below `limit` that is a GET route with (or without) a :param
+static size_t lastMatching(size_t limit, bool param) {
+    size_t i = limit - 1;
+    while (i > 0 && (i % 4 == 3 || (i % 3 == 0) != param)) i--;
+    return i;
+}
+
+// A request path that matches route i
+static String requestPath(size_t i) {
+    String method, pattern;
+    routeFor(i, method, pattern);
+    int param = pattern.indexOf(':');
+    if (param < 0) return pattern;
+    return pattern.substring(0, param) + "7" + pattern.substring(pattern.indexOf('/', param));
+}
+
+int main() {
+    static const size_t COUNTS[] = { 10, 30, 100, 300, 1000 };
+    printf("ns per lookup\n");
+    printf("%6s  %-16s %10s %10s %10s\n", "routes", "request", "linear", "tree", "cached");
+
+    for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); c++) {
+        size_t n = COUNTS[c];
+        HttpRouter router;
+        std::vector<LinearRoute> linear;
+        for (size_t i = 0; i < n; i++) {
+            LinearRoute route;
+            String pattern;
+            routeFor(i, route.method, pattern);
+            route.segments = splitSegments(pattern);
+            linear.push_back(route);
+            router.add(route.method, pattern, static_cast<int>(i));
+        }
+
+        // First route, last static GET route, a :param GET route in the middle, a path with no route
+        struct { const char *name; String path; } requests[] = {
+            { "first", requestPath(0) },
+            { "last static", requestPath(lastMatching(n, false)) },
+            { "param middle", requestPath(lastMatching(n / 2, true)) },
+            { "not found", "/api/group1/missing" },
+        };
+
+        for (size_t r = 0; r < sizeof(requests) / sizeof(requests[0]); r++) {
+            String path = requests[r].path;
+            HttpRequest req;
+            req.methodId = HTTP_METHOD_GET;
+            req.methodView = HttpSlice("GET", 3);
+            req.pathView = HttpSlice(path.c_str(), path.length());
+
+            std::map<String, String> params;
+            int expected = linearFind(linear, "GET", path, params);
+            router.setCacheEnabled(false);
+            if (router.find(req) != expected || (expected < 0) != (r == 3)) {
+                printf("route mismatch for %s\n", path.c_str());
+                return 1;
+            }
+
+            double linearNs = nanosPerCall([&]() {
+                std::map<String, String> found;
+                keep(linearFind(linear, "GET", path, found));
+            }, 10.0, 3);
+            double treeNs = nanosPerCall([&]() { keep(router.find(req)); }, 10.0, 3);
+            router.setCacheEnabled(true);
+            double cachedNs = nanosPerCall([&]() { keep(router.find(req)); }, 10.0, 3);
+            printf("%6zu  %-16s %10.0f %10.0f %10.0f\n", n, requests[r].name, linearNs, treeNs, cachedNs);
+        }
+
+        std::vector<String> unknown;
+        for (int i = 0; i < 16; i++) {
+            unknown.push_back("/api/group1/missing" + String(i));
+        }
+        size_t next = 0;
+        HttpRequest req;
+        req.methodId = HTTP_METHOD_GET;
+        req.methodView = HttpSlice("GET", 3);
+        auto scan = [&]() {
+            const String &path = unknown[next++ % unknown.size()];
+            req.pathView = HttpSlice(path.c_str(), path.length());
+            keep(router.find(req));
+        };
+        double linearNs = nanosPerCall([&]() {
+            std::map<String, String> found;
+            keep(linearFind(linear, "GET", unknown[next++ % unknown.size()], found));
+        }, 10.0, 3);
+        router.setCacheEnabled(false);
+        double treeNs = nanosPerCall(scan, 10.0, 3);
+        router.setCacheEnabled(true);
+        double cachedNs = nanosPerCall(scan, 10.0, 3);
+        printf("%6zu  %-16s %10.0f %10.0f %10.0f\n", n, "404 scan", linearNs, treeNs, cachedNs);
+    }
+    return 0;
+}
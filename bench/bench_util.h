@@ -0,0 +1,36 @@
+// Timing helpers shared by the host benchmarks
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Nanoseconds per call of fn(): the best of `rounds` runs of roughly `roundMillis` each,
+// so that a busy host inflates the result as little as possible
+template <typename Fn>
+double nanosPerCall(Fn fn, double roundMillis = 40.0, int rounds = 5) {
+    typedef std::chrono::steady_clock Clock;
+    size_t calls = 1;
+    double best = 0;
+    for (int round = 0; round < rounds; ) {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < calls; i++) {
+            fn();
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (elapsed < roundMillis * 1e6 && calls < (size_t(1) << 30)) {
+            calls *= 2; // still calibrating
+            continue;
+        }
+        if (round == 0 || elapsed / calls < best) {
+            best = elapsed / calls;
+        }
+        round++;
+    }
+    return best;
+}
+
+// Keeps a result alive so the compiler cannot drop the work that produced it
+template <typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
@@ -0,0 +1,96 @@
+// Socket writes and TCP segments per response: one print per header line (as respondToClient
+// used to send them) versus the head gathered into one buffer with the start of the body.
+//
+// Segments assume every write is pushed on its own (TCP_NODELAY). With Nagle on, the extra
+// small writes instead wait for the client's - usually delayed - ACK.
+#include "bench_util.h"
+#include <http_server.h>
+
+struct Count {
+    double writes;
+    double segments;
+};
+
+static const int REQUESTS = 50;
+
+// Writes per response when the server answers `path` on a keep-alive connection
+static Count measureServer(HttpServer &server, const char *path, std::string &lastResponse) {
+    std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: robot\r\n\r\n";
+    std::shared_ptr<MockSocket> socket(new MockSocket());
+    WiFiServer::pending.push_back(WiFiClient(socket));
+    server.tick(); // accept
+    for (int i = 0; i < REQUESTS; i++) {
+        socket->sent.clear();
+        socket->received = request;
+        server.tick();
+        server.tick(); // whatever did not fit is sent on the next tick
+    }
+    lastResponse = socket->sent;
+    Count count = { static_cast<double>(socket->writes) / REQUESTS, static_cast<double>(socket->segments) / REQUESTS };
+    socket->open = false;
+    server.tick();
+    return count;
+}
+
+// Replays a response the way the old respondToClient wrote it: println() for the status line,
+// print(name), print(": "), println(value) per header, then the body in 512-byte writes
+static Count measurePrintPerLine(const std::string &response) {
+    std::shared_ptr<MockSocket> socket(new MockSocket());
+    WiFiClient client(socket);
+    size_t headEnd = response.find("\r\n\r\n");
+    size_t lineStart = 0;
+    bool statusLine = true;
+    while (lineStart < headEnd) {
+        size_t lineEnd = response.find("\r\n", lineStart);
+        std::string line = response.substr(lineStart, lineEnd - lineStart);
+        if (statusLine) {
+            client.println(line.c_str());
+            statusLine = false;
+        } else {
+            size_t colon = line.find(": ");
+            client.print(line.substr(0, colon).c_str());
+            client.print(": ");
+            client.println(line.substr(colon + 2).c_str());
+        }
+        lineStart = lineEnd + 2;
+    }
+    client.println();
+    const char *body = response.data() + headEnd + 4;
+    size_t bodyLength = response.size() - headEnd - 4;
+    for (size_t offset = 0; offset < bodyLength; offset += 512) {
+        client.write(reinterpret_cast<const uint8_t*>(body) + offset, std::min<size_t>(512, bodyLength - offset));
+    }
+    Count count = { static_cast<double>(socket->writes), static_cast<double>(socket->segments) };
+    return count;
+}
+
+int main() {
+    HttpServer server;
+    server.setKeepAlive(true);
+    server.on("GET", "/api/status", [](HttpRequest &req) {
+        HubHttpResponse response(200, "{\"battery\":87,\"mode\":\"auto\",\"uptime\":5123}");
+        response.setHeader("Content-Type", "application/json");
+        response.setHeader("Cache-Control", "no-store");
+        response.setHeader("X-Robot-Id", "rover-7");
+        return response;
+    });
+    server.on("GET", "/log/4k", [](HttpRequest &req) {
+        return HubHttpResponse(200, String(std::string(4096, 'l').c_str()));
+    });
+    server.on("GET", "/log/20k", [](HttpRequest &req) {
+        return HubHttpResponse(200, String(std::string(20480, 'l').c_str()));
+    });
+    server.begin();
+
+    static const char *PATHS[] = { "/api/status", "/missing", "/log/4k", "/log/20k" };
+    printf("per response: socket writes / TCP segments\n");
+    printf("%-12s %8s %18s %18s\n", "GET", "bytes", "print per line", "gathered");
+    for (size_t p = 0; p < sizeof(PATHS) / sizeof(PATHS[0]); p++) {
+        std::string response;
+        Count gathered = measureServer(server, PATHS[p], response);
+        Count before = measurePrintPerLine(response);
+        printf("%-12s %8zu %8.0f / %-7.0f %8.0f / %-7.0f\n", PATHS[p], response.size(),
+               before.writes, before.segments, gathered.writes, gathered.segments);
+    }
+    return 0;
+}
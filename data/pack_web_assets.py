@@ -0,0 +1,137 @@
+#!/usr/bin/env python
+#
+# Web asset packer for HttpServer::serveStatic()
+#
+# Gzips the compressible files of a web UI build ahead of time, so the device only ever
+# sends precompressed bytes (it never compresses anything itself). Each compressed file is
+# written next to its original as <name>.gz - serveStatic() picks that sibling when the
+# request's Accept-Encoding allows gzip and sets Content-Encoding / Vary.
+#
+# Usage:
+#   python pack_web_assets.py ui/dist data/www                 # copy + gzip into data/www (for LittleFS)
+#   python pack_web_assets.py ui/dist data/www --gzip-only     # keep only the .gz of compressed files
+#   python pack_web_assets.py ui/dist data/www --header src/web_assets.h
+#                                                              # also write an HttpEmbeddedFile table for
+#                                                              # board_build.embed_files
+#
+# Only the Python standard library is needed. Output is deterministic (no timestamps in the
+# gzip headers), so unchanged assets produce unchanged files.
+
+from __future__ import print_function
+
+import argparse
+import gzip
+import io
+import os
+import re
+import shutil
+import sys
+
+COMPRESSIBLE = {'.html', '.htm', '.css', '.js', '.mjs', '.json', '.map', '.svg', '.txt', '.xml', '.csv', '.ico', '.wasm', '.ttf'}
+
+
+def status(msg):
+    sys.stderr.write('pack_web_assets.py: ')
+    sys.stderr.write(msg)
+    sys.stderr.write('\n')
+
+
+def gzip_bytes(data):
+    out = io.BytesIO()
+    with gzip.GzipFile(filename='', mode='wb', compresslevel=9, fileobj=out, mtime=0) as gz:
+        gz.write(data)
+    return out.getvalue()
+
+
+def pack(source, output, gzip_only):
+    """ Copy source into output, adding .gz siblings. Returns [(url path, file path)] """
+    packed = []
+    for root, dirs, files in os.walk(source):
+        dirs.sort()
+        for name in sorted(files):
+            if name.endswith('.gz'):
+                continue
+            src = os.path.join(root, name)
+            rel = os.path.relpath(src, source).replace(os.sep, '/')
+            dst = os.path.join(output, rel)
+            if not os.path.isdir(os.path.dirname(dst)):
+                os.makedirs(os.path.dirname(dst))
+
+            with open(src, 'rb') as f:
+                data = f.read()
+            compressed = None
+            if os.path.splitext(name)[1].lower() in COMPRESSIBLE:
+                compressed = gzip_bytes(data)
+                if len(compressed) >= len(data):
+                    compressed = None  # not worth it
+
+            if compressed is not None:
+                with open(dst + '.gz', 'wb') as f:
+                    f.write(compressed)
+                packed.append(('/' + rel + '.gz', dst + '.gz'))
+                status('%s: %d -> %d bytes' % (rel, len(data), len(compressed)))
+            if compressed is None or not gzip_only:
+                shutil.copyfile(src, dst)
+                packed.append(('/' + rel, dst))
+            elif os.path.exists(dst):
+                os.remove(dst)
+    return packed
+
+
+def embed_symbol(path):
+    # Same mangling as the linker's binary embedding: every non-alphanumeric char becomes '_'
+    return '_binary_' + re.sub(r'[^A-Za-z0-9]', '_', path)
+
+
+def write_header(header, packed, project_root):
+    lines = [
+        '// Generated by pack_web_assets.py - do not edit',
+        '#pragma once',
+        '',
+        '#include <http_static_files.h>',
+        '',
+    ]
+    entries = []
+    embed = []
+    for index, (url, path) in enumerate(packed):
+        rel = os.path.relpath(path, project_root).replace(os.sep, '/')
+        symbol = embed_symbol(rel)
+        embed.append(rel)
+        lines.append('extern const uint8_t web_asset_%d_start[] asm("%s_start");' % (index, symbol))
+        lines.append('extern const uint8_t web_asset_%d_end[] asm("%s_end");' % (index, symbol))
+        entries.append('    { "%s", web_asset_%d_start, (size_t)(web_asset_%d_end - web_asset_%d_start), nullptr },'
+                       % (url, index, index, index))
+    lines.append('')
+    lines.append('static const HttpEmbeddedFile WEB_ASSETS[] = {')
+    lines.extend(entries)
+    lines.append('};')
+    lines.append('static const size_t WEB_ASSET_COUNT = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);')
+    lines.append('')
+    with open(header, 'w') as f:
+        f.write('\n'.join(lines))
+
+    status('add to platformio.ini:\nboard_build.embed_files =\n    ' + '\n    '.join(embed))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Precompress web assets for HttpServer::serveStatic()')
+    parser.add_argument('source', help='directory with the web UI build')
+    parser.add_argument('output', help='directory to write the packed assets to (e.g. data/www)')
+    parser.add_argument('--gzip-only', action='store_true',
+                        help='drop the uncompressed copy of files that were compressed (clients without gzip get 406)')
+    parser.add_argument('--header', help='write an HttpEmbeddedFile table for board_build.embed_files to this file')
+    parser.add_argument('--project-root', default='.',
+                        help='PlatformIO project directory, embed paths are relative to it (default: .)')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.source):
+        status('not a directory: ' + args.source)
+        return 1
+    packed = pack(args.source, args.output, args.gzip_only)
+    if args.header:
+        write_header(args.header, packed, args.project_root)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,417 @@
+#include "http_router.h"
+#include "http_server.h"
+
+// ============================================================================
+// HTTP Methods
+// ============================================================================
+
+HttpMethod httpMethodFromName(const char *name, size_t length) {
+    // Switch on length + first letter so custom verbs are rejected without a compare
+    switch (length) {
+        case 0:
+            return HTTP_METHOD_ANY;
+        case 3:
+            if ((name[0] | 0x20) == 'g' && strncasecmp(name, "GET", 3) == 0) return HTTP_METHOD_GET;
+            if ((name[0] | 0x20) == 'p' && strncasecmp(name, "PUT", 3) == 0) return HTTP_METHOD_PUT;
+            break;
+        case 4:
+            if ((name[0] | 0x20) == 'p' && strncasecmp(name, "POST", 4) == 0) return HTTP_METHOD_POST;
+            if ((name[0] | 0x20) == 'h' && strncasecmp(name, "HEAD", 4) == 0) return HTTP_METHOD_HEAD;
+            break;
+        case 5:
+            if ((name[0] | 0x20) == 'p' && strncasecmp(name, "PATCH", 5) == 0) return HTTP_METHOD_PATCH;
+            break;
+        case 6:
+            if ((name[0] | 0x20) == 'd' && strncasecmp(name, "DELETE", 6) == 0) return HTTP_METHOD_DELETE;
+            break;
+        case 7:
+            if ((name[0] | 0x20) == 'o' && strncasecmp(name, "OPTIONS", 7) == 0) return HTTP_METHOD_OPTIONS;
+            break;
+    }
+    return HTTP_METHOD_OTHER;
+}
+
+const char* httpMethodName(HttpMethod method) {
+    switch (method) {
+        case HTTP_METHOD_GET: return "GET";
+        case HTTP_METHOD_HEAD: return "HEAD";
+        case HTTP_METHOD_POST: return "POST";
+        case HTTP_METHOD_PUT: return "PUT";
+        case HTTP_METHOD_DELETE: return "DELETE";
+        case HTTP_METHOD_PATCH: return "PATCH";
+        case HTTP_METHOD_OPTIONS: return "OPTIONS";
+        default: return "";
+    }
+}
+
+// ============================================================================
+// HttpRouter Implementation
+// ============================================================================
+
+static int compareSegment(const char *segment, size_t length, const String &label) {
+    size_t labelLength = label.length();
+    int cmp = memcmp(segment, label.c_str(), length < labelLength ? length : labelLength);
+    if (cmp != 0) return cmp;
+    return length < labelLength ? -1 : (length > labelLength ? 1 : 0);
+}
+
+static uint32_t hashPath(uint8_t method, const char *path, size_t length) {
+    // FNV-1a, a 32-bit word per step (memcpy keeps the loads legal on cores without unaligned
+    // access). The cache compares the whole path anyway, so the hash only has to spread paths.
+    uint32_t hash = (2166136261u ^ method) ^ static_cast<uint32_t>(length);
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        uint32_t word;
+        memcpy(&word, path + i, 4);
+        hash = (hash ^ word) * 16777619u;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ static_cast<uint8_t>(path[i])) * 16777619u;
+    }
+    return hash != 0 ? hash : 1; // 0 marks an empty slot
+}
+
+void HttpRouter::clear() {
+    nodes.clear();
+    nodes.push_back(Node());
+    numRoutes = 0;
+    invalidateCache();
+}
+
+void HttpRouter::setCacheEnabled(bool enabled) {
+    cacheEnabled = enabled;
+    invalidateCache();
+}
+
+void HttpRouter::invalidateCache() {
+    // Entries point at leaves, which move when the tree grows
+    memset(cacheHash, 0, sizeof(cacheHash));
+    memset(missHash, 0, sizeof(missHash));
+    cacheClock = 0;
+}
+
+// Replace an empty slot or else the least recently used one
+template <typename Entry>
+static size_t pickSlot(const uint32_t *hashes, const Entry *entries, size_t count) {
+    size_t slot = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (hashes[i] == 0) {
+            return i;
+        }
+        if (entries[i].lastUsed < entries[slot].lastUsed) {
+            slot = i;
+        }
+    }
+    return slot;
+}
+
+const HttpRouter::Leaf* HttpRouter::lookupCache(uint32_t hash, HttpRequest &req) const {
+    for (size_t i = 0; i < CACHE_SIZE; i++) {
+        if (cacheHash[i] != hash) {
+            continue;
+        }
+        CacheEntry &entry = cache[i];
+        if (entry.method != req.methodId || entry.pathLength != req.pathView.length ||
+            memcmp(entry.path, req.pathView.data, entry.pathLength) != 0) {
+            continue;
+        }
+        entry.lastUsed = ++cacheClock;
+        const char *path = req.pathView.data;
+        req.numParamViews = entry.numParams;
+        for (size_t p = 0; p < entry.numParams; p++) {
+            req.paramViews[p].name = HttpSlice(entry.leaf->paramNames[p].c_str(), entry.leaf->paramNames[p].length());
+            req.paramViews[p].value = HttpSlice(path + entry.paramOffset[p], entry.paramLength[p]);
+        }
+        if (entry.remainingLength > 0 || entry.remainingOffset > 0) {
+            req.remainingPathView = HttpSlice(path + entry.remainingOffset, entry.remainingLength);
+        }
+        return entry.leaf;
+    }
+    return nullptr;
+}
+
+void HttpRouter::storeCache(uint32_t hash, const Leaf *leaf, const HttpRequest &req) const {
+    if (req.numParamViews > CACHE_MAX_PARAMS) {
+        return;
+    }
+    size_t index = pickSlot(cacheHash, cache, CACHE_SIZE);
+    CacheEntry *slot = &cache[index];
+    const char *path = req.pathView.data;
+    cacheHash[index] = hash;
+    slot->leaf = leaf;
+    slot->lastUsed = ++cacheClock;
+    slot->method = static_cast<uint8_t>(req.methodId);
+    slot->pathLength = static_cast<uint8_t>(req.pathView.length);
+    memcpy(slot->path, path, req.pathView.length);
+    slot->numParams = static_cast<uint8_t>(req.numParamViews);
+    for (size_t p = 0; p < req.numParamViews; p++) {
+        slot->paramOffset[p] = static_cast<uint8_t>(req.paramViews[p].value.data - path);
+        slot->paramLength[p] = static_cast<uint8_t>(req.paramViews[p].value.length);
+    }
+    // A wildcard's rest always lies inside the path; (0, 0) means there is none
+    slot->remainingOffset = req.remainingPathView.data ? static_cast<uint8_t>(req.remainingPathView.data - path) : 0;
+    slot->remainingLength = static_cast<uint8_t>(req.remainingPathView.length);
+}
+
+const HttpRouter::MissEntry* HttpRouter::lookupMiss(uint32_t hash, const HttpRequest &req) const {
+    for (size_t i = 0; i < MISS_CACHE_SIZE; i++) {
+        MissEntry &entry = missCache[i];
+        if (missHash[i] == hash && entry.method == req.methodId && entry.pathLength == req.pathView.length &&
+            memcmp(entry.path, req.pathView.data, entry.pathLength) == 0) {
+            entry.lastUsed = ++cacheClock;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void HttpRouter::storeMiss(uint32_t hash, int pathMatch, const HttpRequest &req) const {
+    size_t index = pickSlot(missHash, missCache, MISS_CACHE_SIZE);
+    MissEntry *slot = &missCache[index];
+    missHash[index] = hash;
+    slot->method = static_cast<uint8_t>(req.methodId);
+    slot->pathLength = static_cast<uint8_t>(req.pathView.length);
+    slot->pathMatch = pathMatch;
+    slot->lastUsed = ++cacheClock;
+    memcpy(slot->path, req.pathView.data, req.pathView.length);
+}
+
+int HttpRouter::findStaticChild(const Node &node, const char *segment, size_t length, size_t &insertAt) const {
+    size_t lo = 0;
+    size_t hi = node.children.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = compareSegment(segment, length, nodes[node.children[mid]].segment);
+        if (cmp == 0) {
+            insertAt = mid;
+            return node.children[mid];
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    insertAt = lo;
+    return -1;
+}
+
+int HttpRouter::add(const String &method, const String &pattern, int route) {
+    size_t current = 0;
+    std::vector<String> paramNames;
+
+    // Walk (and extend) the tree one segment at a time - empty segments are ignored
+    const char *p = pattern.c_str();
+    const char *end = p + pattern.length();
+    while (p < end) {
+        const char *slash = static_cast<const char*>(memchr(p, '/', end - p));
+        if (slash == nullptr) slash = end;
+        size_t length = slash - p;
+        if (length > 0) {
+            bool last = slash >= end || slash + 1 >= end;
+            if (last && (length == 1 || length == 2) && p[0] == '*' && p[length - 1] == '*') {
+                // "*" / "**" as the final segment: everything below this point
+                if (nodes[current].wildcardChild < 0) {
+                    nodes[current].wildcardChild = static_cast<int>(nodes.size());
+                    nodes.push_back(Node());
+                }
+                current = nodes[current].wildcardChild;
+            } else if (*p == ':') {
+                paramNames.push_back(String(p + 1, length - 1));
+                if (nodes[current].paramChild < 0) {
+                    nodes[current].paramChild = static_cast<int>(nodes.size());
+                    nodes.push_back(Node());
+                }
+                current = nodes[current].paramChild;
+            } else {
+                size_t insertAt;
+                int child = findStaticChild(nodes[current], p, length, insertAt);
+                if (child < 0) {
+                    child = static_cast<int>(nodes.size());
+                    Node node;
+                    node.segment = String(p, length);
+                    nodes.push_back(node);
+                    nodes[current].children.insert(nodes[current].children.begin() + insertAt, static_cast<uint16_t>(child));
+                }
+                current = child;
+            }
+        }
+        p = slash + 1;
+    }
+
+    Node &node = nodes[current];
+    HttpMethod methodId = httpMethodFromName(method.c_str(), method.length());
+    if (methodId == HTTP_METHOD_OTHER) {
+        for (size_t i = 0; i < node.leaves.size(); i++) {
+            if (node.leaves[i].method == HTTP_METHOD_OTHER && node.leaves[i].customMethod.equalsIgnoreCase(method)) {
+                return node.leaves[i].route;
+            }
+        }
+    } else if (node.methodLeaf[methodId] >= 0) {
+        return node.leaves[node.methodLeaf[methodId]].route;
+    }
+
+    Leaf leaf;
+    leaf.method = methodId;
+    if (methodId == HTTP_METHOD_OTHER) {
+        leaf.customMethod = method;
+    }
+    leaf.route = route;
+    leaf.paramNames = paramNames;
+    if (methodId != HTTP_METHOD_OTHER) {
+        node.methodLeaf[methodId] = static_cast<int8_t>(node.leaves.size());
+    }
+    node.leaves.push_back(leaf);
+    numRoutes++;
+    invalidateCache();
+    return route;
+}
+
+String HttpRouter::allowedMethods(int pathMatch) const {
+    String allow;
+    if (pathMatch < 0 || pathMatch >= static_cast<int>(nodes.size())) {
+        return allow;
+    }
+    const Node &node = nodes[pathMatch];
+    for (int m = 0; m < HTTP_METHOD_OTHER; m++) {
+        // A GET route answers HEAD as well (see selectLeaf)
+        bool headViaGet = m == HTTP_METHOD_HEAD && node.methodLeaf[HTTP_METHOD_GET] >= 0;
+        if (node.methodLeaf[m] >= 0 || headViaGet) {
+            if (allow.length() > 0) allow += ", ";
+            allow += httpMethodName(static_cast<HttpMethod>(m));
+        }
+    }
+    for (size_t i = 0; i < node.leaves.size(); i++) {
+        if (node.leaves[i].method == HTTP_METHOD_OTHER) {
+            if (allow.length() > 0) allow += ", ";
+            allow += node.leaves[i].customMethod;
+        }
+    }
+    return allow;
+}
+
+int HttpRouter::find(HttpRequest &req, int *pathMatch) const {
+    req.numParamViews = 0;
+    req.remainingPathView = HttpSlice();
+    // A cached miss has to restore pathMatch for any later caller, so it is always worked out
+    int ownMatch;
+    if (pathMatch == nullptr) {
+        pathMatch = &ownMatch;
+    }
+    *pathMatch = -1;
+
+    // Custom verbs are compared by name, so only interned methods are cached
+    bool cacheable = cacheEnabled && req.methodId < HTTP_METHOD_OTHER && req.pathView.length <= CACHE_PATH_MAX;
+    uint32_t hash = 0;
+    if (cacheable) {
+        hash = hashPath(static_cast<uint8_t>(req.methodId), req.pathView.data, req.pathView.length);
+        const Leaf *leaf = lookupCache(hash, req);
+        if (leaf != nullptr) {
+            hits++;
+            return leaf->route;
+        }
+        const MissEntry *miss = lookupMiss(hash, req);
+        if (miss != nullptr) {
+            hits++;
+            *pathMatch = miss->pathMatch;
+            return NO_ROUTE;
+        }
+        misses++;
+    }
+
+    MatchContext ctx = { req, req.pathView.data + req.pathView.length, pathMatch, nullptr };
+    int route = match(0, req.pathView.data, 0, ctx);
+    // Misses have their own slots so a scan of unknown paths cannot evict the hot entries
+    if (cacheable) {
+        if (route != NO_ROUTE) {
+            storeCache(hash, ctx.leaf, req);
+        } else {
+            storeMiss(hash, *pathMatch, req);
+        }
+    }
+    return route;
+}
+
+int HttpRouter::selectLeaf(size_t nodeIndex, MatchContext &ctx) const {
+    // A route for this exact method wins over an any-method route
+    const Node &node = nodes[nodeIndex];
+    int leafIndex = -1;
+    if (ctx.req.methodId == HTTP_METHOD_OTHER) {
+        for (size_t i = 0; i < node.leaves.size(); i++) {
+            if (node.leaves[i].method == HTTP_METHOD_OTHER &&
+                ctx.req.methodView.equalsIgnoreCase(node.leaves[i].customMethod.c_str())) {
+                leafIndex = static_cast<int>(i);
+                break;
+            }
+        }
+    } else if (ctx.req.methodId < HTTP_METHOD_COUNT) {
+        leafIndex = node.methodLeaf[ctx.req.methodId];
+    }
+    if (leafIndex < 0 && ctx.req.methodId == HTTP_METHOD_HEAD) {
+        leafIndex = node.methodLeaf[HTTP_METHOD_GET]; // HEAD is GET without the body (RFC 9110 9.3.2)
+    }
+    if (leafIndex < 0) {
+        leafIndex = node.methodLeaf[HTTP_METHOD_ANY];
+    }
+    if (leafIndex < 0 && ctx.pathMatch != nullptr && *ctx.pathMatch < 0 && !node.leaves.empty()) {
+        *ctx.pathMatch = static_cast<int>(nodeIndex); // path exists, method does not
+    }
+    return leafIndex;
+}
+
+int HttpRouter::finishMatch(const Leaf &leaf, size_t depth, MatchContext &ctx) const {
+    HttpRequest &req = ctx.req;
+    req.numParamViews = depth < HttpRequest::MAX_PARAMS ? depth : HttpRequest::MAX_PARAMS;
+    for (size_t i = 0; i < req.numParamViews; i++) {
+        req.paramViews[i].name = HttpSlice(leaf.paramNames[i].c_str(), leaf.paramNames[i].length());
+    }
+    ctx.leaf = &leaf;
+    return leaf.route;
+}
+
+int HttpRouter::match(size_t nodeIndex, const char *p, size_t depth, MatchContext &ctx) const {
+    const Node &node = nodes[nodeIndex];
+    while (p < ctx.end && *p == '/') {
+        p++;
+    }
+
+    if (p == ctx.end) {
+        int leafIndex = selectLeaf(nodeIndex, ctx);
+        if (leafIndex >= 0) {
+            return finishMatch(node.leaves[leafIndex], depth, ctx);
+        }
+    } else {
+        const char *slash = static_cast<const char*>(memchr(p, '/', ctx.end - p));
+        if (slash == nullptr) slash = ctx.end;
+        size_t length = slash - p;
+
+        // Static segment first, then the param child (backtracking if a branch has no route)
+        size_t insertAt;
+        int child = findStaticChild(node, p, length, insertAt);
+        if (child >= 0) {
+            int route = match(child, slash, depth, ctx);
+            if (route != NO_ROUTE) {
+                return route;
+            }
+        }
+        if (node.paramChild >= 0) {
+            if (depth < HttpRequest::MAX_PARAMS) {
+                ctx.req.paramViews[depth].value = HttpSlice(p, length);
+            }
+            int route = match(node.paramChild, slash, depth + 1, ctx);
+            if (route != NO_ROUTE) {
+                return route;
+            }
+        }
+    }
+
+    // Finally a trailing wildcard takes whatever is left (possibly nothing)
+    if (node.wildcardChild >= 0) {
+        int leafIndex = selectLeaf(node.wildcardChild, ctx);
+        if (leafIndex >= 0) {
+            ctx.req.remainingPathView = HttpSlice(p, ctx.end - p);
+            return finishMatch(nodes[node.wildcardChild].leaves[leafIndex], depth, ctx);
+        }
+    }
+    return NO_ROUTE;
+}
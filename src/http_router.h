@@ -0,0 +1,181 @@
+#ifndef HUB_HTTP_ROUTER_H
+#define HUB_HTTP_ROUTER_H
+
+#include <Arduino.h>
+#include <vector>
+
+class HttpRequest;
+
+/**
+ * @brief HTTP methods, interned once when a request is parsed or a route is registered
+ *
+ * Any other verb is HTTP_METHOD_OTHER and is compared by name.
+ */
+enum HttpMethod {
+    HTTP_METHOD_GET = 0,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_PATCH,
+    HTTP_METHOD_OPTIONS,
+    HTTP_METHOD_OTHER, // custom verb
+    HTTP_METHOD_ANY,   // routes only - matches every method
+    HTTP_METHOD_COUNT
+};
+
+/**
+ * @brief Intern a method name (case-insensitive)
+ * @return The method, HTTP_METHOD_ANY for an empty name or HTTP_METHOD_OTHER for a custom verb
+ */
+HttpMethod httpMethodFromName(const char *name, size_t length);
+
+/**
+ * @brief Get the canonical name of a method
+ * @return The name ("GET", ...) or "" for HTTP_METHOD_OTHER / HTTP_METHOD_ANY
+ */
+const char* httpMethodName(HttpMethod method);
+
+/**
+ * @brief Segment tree that resolves a request path to a registered route
+ *
+ * Patterns are split into segments once, when they are registered. Each node keeps its
+ * static children sorted by segment text, an optional ":param" child, an optional trailing
+ * wildcard ("*" or "**") child and a table of the routes that end there, indexed by
+ * HttpMethod. A lookup walks the request path once, binary searching the static children
+ * and falling back to the param and wildcard children, and never allocates.
+ *
+ * Precedence: at each segment a static segment beats a ":param" segment, which beats a
+ * wildcard. A route for the request's method beats an any-method route. HEAD requests
+ * without a HEAD route use the GET route (the server then sends only the head).
+ *
+ * Empty segments are skipped, in patterns and in request paths alike, so "//files///a/"
+ * resolves like "/files/a". A wildcard's remaining path is taken from the request as sent.
+ */
+class HttpRouter {
+public:
+    static const int NO_ROUTE = -1;
+    static const size_t CACHE_SIZE = 8;           // recently resolved (method, path) pairs
+    static const size_t MISS_CACHE_SIZE = 4;      // recent (method, path) pairs with no route
+    static const size_t CACHE_PATH_MAX = 64;      // longer paths are never cached
+    static const size_t CACHE_MAX_PARAMS = 8;
+
+    HttpRouter() : cacheEnabled(true), hits(0), misses(0) { clear(); }
+
+    /**
+     * @brief Register a route
+     * @param method HTTP method (case-insensitive, custom verbs allowed), empty for any method
+     * @param pattern Path pattern, may contain :params and end in a "*" wildcard segment
+     * @param route Id to return from find() for this route
+     * @return The id now registered for method + pattern (an existing id is kept)
+     */
+    int add(const String &method, const String &pattern, int route);
+
+    /**
+     * @brief Resolve a request to a route
+     *
+     * Reads the request's methodId/methodView/pathView and fills in its paramViews and
+     * remainingPathView for the matched route.
+     * @param req The request
+     * @param pathMatch If not null, receives an id for allowedMethods() when the path
+     *                  matched a route but the method did not (-1 otherwise)
+     * @return The matched route id or NO_ROUTE
+     */
+    int find(HttpRequest &req, int *pathMatch = nullptr) const;
+
+    /**
+     * @brief List the methods registered for a path (for an Allow header)
+     * @param pathMatch Id reported by find()
+     * @return Comma separated methods, e.g. "GET, HEAD, POST" (HEAD whenever GET is routed)
+     */
+    String allowedMethods(int pathMatch) const;
+
+    void clear();
+    size_t size() const { return numRoutes; }
+
+    /**
+     * @brief Enable or disable the cache of recently resolved routes
+     *
+     * Repeated requests for the same method and path (dashboards polling a few endpoints)
+     * are answered from a small LRU cache without walking the tree. Paths without a route
+     * (a client polling a removed endpoint) go to a separate, smaller cache, so a scan of
+     * unknown paths cannot evict the hot entries. Both are emptied whenever a route is added.
+     */
+    void setCacheEnabled(bool enabled);
+    uint32_t cacheHits() const { return hits; }
+    uint32_t cacheMisses() const { return misses; }
+
+private:
+    struct Leaf {
+        HttpMethod method;
+        String customMethod;            // name of an HTTP_METHOD_OTHER verb
+        int route;
+        std::vector<String> paramNames; // one per ":param" segment on the way here
+    };
+
+    struct Node {
+        String segment;                 // static segment text (unused for param nodes)
+        std::vector<uint16_t> children; // static children, sorted by segment
+        int paramChild;                 // node index of the ":param" child, -1 if none
+        int wildcardChild;              // node index of the trailing wildcard child, -1 if none
+        std::vector<Leaf> leaves;       // routes ending at this node
+        int8_t methodLeaf[HTTP_METHOD_COUNT]; // index into leaves per method, -1 if none (custom verbs are scanned)
+
+        Node() : paramChild(-1), wildcardChild(-1) { memset(methodLeaf, -1, sizeof(methodLeaf)); }
+    };
+
+    struct MatchContext {
+        HttpRequest &req;
+        const char *end; // end of the request path
+        int *pathMatch;
+        const Leaf *leaf; // the matched route, for the cache
+    };
+
+    struct CacheEntry {
+        const Leaf *leaf;        // entries are dropped whenever the tree changes
+        uint32_t lastUsed;
+        uint8_t method;
+        uint8_t pathLength;
+        uint8_t numParams;
+        uint8_t paramOffset[CACHE_MAX_PARAMS]; // param values as offsets into the path
+        uint8_t paramLength[CACHE_MAX_PARAMS];
+        uint8_t remainingOffset;
+        uint8_t remainingLength;
+        char path[CACHE_PATH_MAX];
+    };
+
+    struct MissEntry {
+        uint8_t method;
+        uint8_t pathLength;
+        int pathMatch;           // what find() reported for allowedMethods()
+        uint32_t lastUsed;
+        char path[CACHE_PATH_MAX];
+    };
+
+    std::vector<Node> nodes; // nodes[0] is the root
+    size_t numRoutes;
+
+    bool cacheEnabled;
+    // Slot hashes sit apart from the entries so a lookup that misses scans a few words, not
+    // every entry (0 = empty slot)
+    mutable uint32_t cacheHash[CACHE_SIZE];
+    mutable uint32_t missHash[MISS_CACHE_SIZE];
+    mutable CacheEntry cache[CACHE_SIZE];
+    mutable MissEntry missCache[MISS_CACHE_SIZE];
+    mutable uint32_t cacheClock;
+    mutable uint32_t hits;
+    mutable uint32_t misses;
+
+    void invalidateCache();
+    const Leaf* lookupCache(uint32_t hash, HttpRequest &req) const;
+    void storeCache(uint32_t hash, const Leaf *leaf, const HttpRequest &req) const;
+    const MissEntry* lookupMiss(uint32_t hash, const HttpRequest &req) const;
+    void storeMiss(uint32_t hash, int pathMatch, const HttpRequest &req) const;
+
+    int findStaticChild(const Node &node, const char *segment, size_t length, size_t &insertAt) const;
+    int match(size_t nodeIndex, const char *p, size_t depth, MatchContext &ctx) const;
+    int selectLeaf(size_t nodeIndex, MatchContext &ctx) const;
+    int finishMatch(const Leaf &leaf, size_t depth, MatchContext &ctx) const;
+};
+
+#endif // HUB_HTTP_ROUTER_H
@@ -35,6 +35,7 @@ void HttpServer::begin() {
     cfg.connectionInactivityTimeout = connectionInactivityTimeout;
     cfg.maxConnections = maxConnections;
     cfg.keepAlive = keepAlive;
+    cfg.zeroCopyRequests = zeroCopyRequests;
     cfg.debug = debug;
     begin(cfg);
 }
@@ -53,6 +54,7 @@ void HttpServer::begin(const HttpServerConfig &config) {
     connectionInactivityTimeout = config.connectionInactivityTimeout;
     maxConnections = config.maxConnections;
     keepAlive = config.keepAlive;
+    zeroCopyRequests = config.zeroCopyRequests;
     debug = config.debug;
 
     server = WiFiServer(port);
@@ -78,8 +80,50 @@ void HttpServer::stop() {
     }
 }
 
+static bool patternUnderPrefix(const String &pattern, const String &prefix) {
+    size_t len = prefix.length();
+    while (len > 0 && prefix[len - 1] == '/') len--; // "/api/" == "/api", "/" covers everything
+    if (pattern.length() < len || strncmp(pattern.c_str(), prefix.c_str(), len) != 0) {
+        return false;
+    }
+    return pattern.length() == len || pattern[len] == '/';
+}
+
+void HttpServer::resolveMiddlewares(RoutePattern &rp) const {
+    rp.middlewares.clear();
+    for (size_t i = 0; i < scopedMiddlewares.size(); i++) {
+        if (patternUnderPrefix(rp.pattern, scopedMiddlewares[i].prefix)) {
+            rp.middlewares.push_back(scopedMiddlewares[i].handler);
+        }
+    }
+    rp.middlewares.insert(rp.middlewares.end(), rp.routeMiddlewares.begin(), rp.routeMiddlewares.end());
+}
+
+void HttpServer::addRoute(const RoutePattern &rp) {
+    int id = router.add(rp.method, rp.pattern, static_cast<int>(routes.size()));
+    if (id == static_cast<int>(routes.size())) {
+        routes.push_back(rp);
+    } else {
+        routes[id] = rp; // same method + path registered again - replace it
+        dropCachedResponses(id);
+    }
+    resolveMiddlewares(routes[id]);
+}
+
+int HttpServer::findRegisteredRoute(const String &method, const String &path) const {
+    for (size_t r = 0; r < routes.size(); r++) {
+        if (routes[r].pattern == path && routes[r].method.equalsIgnoreCase(method)) {
+            return static_cast<int>(r);
+        }
+    }
+    return -1;
+}
+
 void HttpServer::on(const String& path, RouteHandler handler) {
-    httpHandlers[path] = handler;
+    RoutePattern rp;
+    rp.pattern = path;
+    rp.handler = handler;
+    addRoute(rp);
     
     if (debug && logger) {
         logger->print("[HTTP] Registered route: ");
@@ -88,27 +132,60 @@ void HttpServer::on(const String& path, RouteHandler handler) {
 }
 
 void HttpServer::on(const String &method, const String &path, RouteHandler handler) {
-    // Build pattern handler
     RoutePattern rp;
     rp.method = method;
     rp.pattern = path;
     rp.handler = handler;
-    // Split pattern
-    rp.segments.clear();
-    String tmp = path;
-    if (tmp.length() > 1 && tmp.endsWith("/")) tmp.remove(tmp.length()-1);
-    int start = 0;
-    while (start < tmp.length()) {
-        int idx = tmp.indexOf('/', start);
-        if (idx == -1) idx = tmp.length();
-        String seg = tmp.substring(start, idx);
-        if (seg.length() > 0) {
-            rp.segments.push_back(seg);
-            if (seg.startsWith(":")) rp.hasParams = true;
-        }
-        start = idx + 1;
-    }
-    patternHandlers.push_back(rp);
+    addRoute(rp);
+    if (debug && logger) {
+        logger->print("[HTTP] Registered route: ");
+        logger->print(method);
+        logger->print(" ");
+        logger->println(path);
+    }
+}
+
+void HttpServer::on(const String &method, const String &path, RouteHandler handler,
+                    const std::vector<MiddlewareHandlerBool> &middleware) {
+    RoutePattern rp;
+    rp.method = method;
+    rp.pattern = path;
+    rp.handler = handler;
+    rp.routeMiddlewares.assign(middleware.begin(), middleware.end());
+    addRoute(rp);
+    if (debug && logger) {
+        logger->print("[HTTP] Registered route with middleware: ");
+        logger->print(method);
+        logger->print(" ");
+        logger->println(path);
+    }
+}
+
+void HttpServer::on(const String &path, RouteFillHandler handler) {
+    on(String(), path, handler);
+}
+
+void HttpServer::on(const String &method, const String &path, RouteFillHandler handler) {
+    RoutePattern rp;
+    rp.method = method;
+    rp.pattern = path;
+    rp.fillHandler = handler;
+    addRoute(rp);
+    if (debug && logger) {
+        logger->print("[HTTP] Registered route: ");
+        logger->print(method);
+        logger->print(" ");
+        logger->println(path);
+    }
+}
+
+void HttpServer::on(const String &method, const String &path, RouteHandlerFn handler, void *context) {
+    RoutePattern rp;
+    rp.method = method;
+    rp.pattern = path;
+    rp.handlerFn = handler;
+    rp.handlerContext = context;
+    addRoute(rp);
     if (debug && logger) {
         logger->print("[HTTP] Registered route: ");
         logger->print(method);
@@ -117,6 +194,76 @@ void HttpServer::on(const String &method, const String &path, RouteHandler handl
     }
 }
 
+void HttpServer::on(HttpMethod method, const String &path, RouteHandler handler) {
+    on(String(httpMethodName(method)), path, handler);
+}
+
+void HttpServer::mount(const String &prefix, RouteHandler handler) {
+    String pattern = prefix;
+    if (!pattern.endsWith("/")) pattern += "/";
+    on(pattern + "*", handler);
+}
+
+bool HttpServer::setRouteLimits(const String &method, const String &path, const RouteLimits &limits) {
+    int r = findRegisteredRoute(method, path);
+    if (r >= 0) {
+        routes[r].limits = limits;
+        return true;
+    }
+    if (logger) {
+        logger->print("[HTTP] No route to set limits on: ");
+        logger->println(path);
+    }
+    return false;
+}
+
+bool HttpServer::setResponseCache(const String &method, const String &path, const ResponseCachePolicy &policy) {
+    int r = findRegisteredRoute(method, path);
+    if (r >= 0) {
+        routes[r].cache = policy;
+        dropCachedResponses(r);
+        return true;
+    }
+    if (logger) {
+        logger->print("[HTTP] No route to cache: ");
+        logger->println(path);
+    }
+    return false;
+}
+
+void HttpServer::setResponseCacheBudget(size_t bytes) {
+    responseCacheBudget = bytes;
+    evictResponseCacheUntil(responseCacheBudget);
+}
+
+void HttpServer::invalidateResponseCache() {
+    dropCachedResponses(-1);
+}
+
+bool HttpServer::invalidateResponseCache(const String &method, const String &path) {
+    int r = findRegisteredRoute(method, path);
+    if (r < 0) {
+        return false;
+    }
+    dropCachedResponses(r);
+    return true;
+}
+
+void HttpServer::onUpload(const String &method, const String &path, BodyHandler onBody, RouteHandler onComplete) {
+    RoutePattern rp;
+    rp.method = method;
+    rp.pattern = path;
+    rp.handler = onComplete;
+    rp.bodyHandler = onBody;
+    addRoute(rp);
+    if (debug && logger) {
+        logger->print("[HTTP] Registered upload route: ");
+        logger->print(method);
+        logger->print(" ");
+        logger->println(path);
+    }
+}
+
 void HttpServer::use(MiddlewareHandler middleware) {
     // Wrap the legacy middleware to return true always
     MiddlewareHandlerBool wrapped = [middleware](HttpRequest &req, HubHttpResponse &res) {
@@ -137,8 +284,46 @@ void HttpServer::use(MiddlewareHandlerBool middleware) {
     }
 }
 
+void HttpServer::addScopedMiddleware(const String &prefix, const HttpMiddleware &middleware) {
+    ScopedMiddleware scoped = { prefix, middleware };
+    scopedMiddlewares.push_back(scoped);
+
+    // Attach it to the routes already registered under the prefix (later routes pick it up in addRoute)
+    for (size_t r = 0; r < routes.size(); r++) {
+        if (patternUnderPrefix(routes[r].pattern, prefix)) {
+            resolveMiddlewares(routes[r]);
+        }
+    }
+    if (debug && logger) {
+        logger->print("[HTTP] Registered middleware for: ");
+        logger->println(prefix);
+    }
+}
+
+void HttpServer::use(const String &prefix, MiddlewareHandlerBool middleware) {
+    addScopedMiddleware(prefix, HttpMiddleware(middleware));
+}
+
+void HttpServer::use(MiddlewareHandlerFn middleware, void *context) {
+    middlewares.push_back(HttpMiddleware(middleware, context));
+    if (debug && logger) {
+        logger->println("[HTTP] Registered function middleware");
+    }
+}
+
+void HttpServer::use(const String &prefix, MiddlewareHandlerFn middleware, void *context) {
+    addScopedMiddleware(prefix, HttpMiddleware(middleware, context));
+}
+
 void HttpServer::onError(ErrorHandler handler) {
     errorHandler = handler;
+    errorHandlerFn = nullptr;
+}
+
+void HttpServer::onError(ErrorHandlerFn handler, void *context) {
+    errorHandlerFn = handler;
+    errorHandlerContext = context;
+    errorHandler = nullptr;
 }
 
 void HttpServer::onNotFound(RouteHandler handler) {
@@ -218,6 +403,14 @@ void HttpServer::setKeepAlive(bool enabled) {
     keepAlive = enabled;
 }
 
+void HttpServer::setZeroCopyRequests(bool enabled) {
+    zeroCopyRequests = enabled;
+}
+
+void HttpServer::setRouteCacheEnabled(bool enabled) {
+    router.setCacheEnabled(enabled);
+}
+
 void HttpServer::addDefaultHeader(const String &name, const String &value) {
     defaultHeaders[name] = value;
 }
@@ -262,7 +455,19 @@ void HttpServer::tick() {
             }
             
             esp_task_wdt_reset();   // Feed the watchdog
-            if (!handleConnection(conn)) {
+            // Send what the socket has room for - a slow reader never holds up the other clients
+            if (!conn->flushOutput() && conn->outputStalled(WRITE_TIMEOUT_MS)) {
+                if (logger) {
+                    logger->println("[HTTP] Write timeout");
+                }
+                connections.erase(connections.begin() + i);
+                continue;
+            }
+            // New requests are only read once earlier responses are out
+            if (!conn->hasPendingOutput() && !conn->closeAfterSend && !handleConnection(conn)) {
+                conn->closeAfterSend = true;
+            }
+            if (conn->closeAfterSend && !conn->hasPendingOutput()) {
                 if (debug && logger) {
                     logger->println("[HTTP] Closing client connection after handling");
                 }
@@ -293,6 +498,87 @@ String HttpServer::toLowerCase(const String &str) const {
     return result;
 }
 
+// Whether an If-None-Match list contains the tag (weak comparison, as for GET/HEAD)
+static bool etagListMatches(const HttpSlice &list, const String &etag) {
+    const char *tag = etag.c_str();
+    size_t tagLength = etag.length();
+    if (tagLength > 2 && tag[0] == 'W' && tag[1] == '/') {
+        tag += 2;
+        tagLength -= 2;
+    }
+    const char *p = list.data;
+    const char *end = p + list.length;
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == ',')) p++;
+        if (p < end && *p == '*') {
+            return true;
+        }
+        if (end - p > 2 && p[0] == 'W' && p[1] == '/') {
+            p += 2;
+        }
+        const char *start = p;
+        if (p < end && *p == '"') {
+            p++;
+            while (p < end && *p != '"') p++;
+            if (p < end) p++;
+        } else {
+            while (p < end && *p != ',' && *p != ' ') p++;
+        }
+        if (static_cast<size_t>(p - start) == tagLength && memcmp(start, tag, tagLength) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void appendHex(String &out, uint32_t value) {
+    char digits[9];
+    snprintf(digits, sizeof(digits), "%08x", static_cast<unsigned>(value));
+    out += digits;
+}
+
+void HttpServer::applyConditionalResponse(const HttpRequest &req, HubHttpResponse &response) {
+    if (response.status != 200) {
+        return;
+    }
+    if (response.autoETag && !response.isStreaming()) {
+        // FNV-1a over the body, prefixed by its length
+        const uint8_t *data = response.bodyData != nullptr ? response.bodyData : reinterpret_cast<const uint8_t*>(response.body.c_str());
+        size_t length = response.bodyData != nullptr ? static_cast<size_t>(response.bodyLength) : response.body.length();
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        String tag = "\"";
+        appendHex(tag, static_cast<uint32_t>(length));
+        tag += "-";
+        appendHex(tag, hash);
+        tag += "\"";
+        response.headers["ETag"] = tag;
+    }
+
+    if (req.methodId != HTTP_METHOD_GET && req.methodId != HTTP_METHOD_HEAD) {
+        return;
+    }
+    HttpSlice ifNoneMatch = req.getHeaderView(HTTP_HEADER_IF_NONE_MATCH);
+    if (ifNoneMatch.empty()) {
+        return;
+    }
+    std::map<String, String>::const_iterator etag = response.headers.find("ETag");
+    if (etag == response.headers.end() || !etagListMatches(ifNoneMatch, etag->second)) {
+        return;
+    }
+
+    // The client's copy is current - send only the validators and caching headers
+    response.status = 304;
+    response.body = "";
+    response.bodyGenerator = nullptr;
+    response.bodyData = nullptr;
+    response.bodyLength = -1;
+    response.headers.erase("Content-Type");
+    response.headers.erase("Content-Encoding");
+}
+
 void HttpServer::applyCORS(HubHttpResponse &response) {
     if (!corsEnabled) {
         return;
@@ -304,12 +590,13 @@ void HttpServer::applyCORS(HubHttpResponse &response) {
     response.setHeader("Access-Control-Max-Age", "86400");
 }
 
-void HttpServer::applyMiddlewares(HttpRequest &req, HubHttpResponse &response) {
-    for (size_t i = 0; i < middlewares.size(); i++) {
-        if (!middlewares[i](req, response)) {
-            break; // short-circuit
+bool HttpServer::applyMiddlewares(HttpRequest &req, HubHttpResponse &response, const std::vector<HttpMiddleware> &chain) {
+    for (size_t i = 0; i < chain.size(); i++) {
+        if (!chain[i](req, response)) {
+            return false; // short-circuit
         }
     }
+    return true;
 }
 
 void HttpServer::applyDefaultHeaders(HubHttpResponse &response) {
@@ -321,6 +608,11 @@ void HttpServer::applyDefaultHeaders(HubHttpResponse &response) {
 }
 
 HubHttpResponse HttpServer::generateErrorResponse(int statusCode, const String &message) {
+    if (errorHandlerFn != nullptr) {
+        HubHttpResponse response(statusCode);
+        errorHandlerFn(statusCode, message, response, errorHandlerContext);
+        return response;
+    }
     if (errorHandler) {
         return errorHandler(statusCode, message);
     }
@@ -344,7 +636,10 @@ String HttpServer::getStatusText(int statusCode) {
         case 403: return "Forbidden";
         case 404: return "Not Found";
         case 405: return "Method Not Allowed";
+        case 406: return "Not Acceptable";
+        case 408: return "Request Timeout";
         case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
         case 500: return "Internal Server Error";
         case 501: return "Not Implemented";
         case 503: return "Service Unavailable";
@@ -359,37 +654,32 @@ void HttpServer::logRequest(const HttpRequest &req) {
     
     logger->println("[HTTP] Request:");
     logger->print("  Method: ");
-    logger->println(req.method);
+    logger->println(req.methodView.toString());
     logger->print("  Path: ");
-    logger->println(req.path);
+    logger->println(req.pathView.toString());
     
-    if (req.query.size() > 0) {
-        logger->println("  Query:");
-        for (std::map<String, String>::const_iterator it = req.query.begin(); it != req.query.end(); ++it) {
-            logger->print("    ");
-            logger->print(it->first);
-            logger->print(": ");
-            logger->println(it->second);
-        }
+    if (!req.queryView.empty()) {
+        logger->print("  Query: ");
+        logger->println(req.queryView.toString());
     }
     
-    if (req.headers.size() > 0) {
+    if (req.headerViews.size() > 0) {
         logger->println("  Headers:");
-        for (std::map<String, String>::const_iterator it = req.headers.begin(); it != req.headers.end(); ++it) {
+        for (size_t h = 0; h < req.headerViews.size(); h++) {
             logger->print("    ");
-            logger->print(it->first);
+            logger->print(req.headerViews[h].name.toString());
             logger->print(": ");
-            logger->println(it->second);
+            logger->println(req.headerViews[h].value.toString());
         }
     }
     
-    if (req.body.length() > 0) {
+    if (!req.bodyView.empty()) {
         logger->print("  Body: ");
-        if (req.body.length() > 100) {
-            logger->print(req.body.substring(0, 100));
+        if (req.bodyView.length > 100) {
+            logger->print(HttpSlice(req.bodyView.data, 100).toString());
             logger->println("...");
         } else {
-            logger->println(req.body);
+            logger->println(req.bodyView.toString());
         }
     }
 }
@@ -413,429 +703,1119 @@ bool HttpServer::handleConnection(HttpClientConnection* connection) {
             logger->println("[HTTP] Insufficient memory for new client");
         }
         HubHttpResponse response = generateErrorResponse(503, "Service Unavailable");
-        respondToClient(connection->getClient(), response);
+        respondToClient(connection, response);
         return false;   // Done with this client connection - it can be closed
     }
 
     WiFiClient &client = connection->getClient();
 
-    // Wait for client to be ready for upto 4ms - then give up and try later
-    u64_t startWait = millis();
-    while (millis() - startWait < 4 && !client.available()) {
-        delay(1);
-    }
-
-    if (!client.available()) {
-        return true;
-    }
-
+    // Take only what is already waiting (one read per tick) - never block the tick on a slow client
     if (client.available() > 0) {
-        const char* method;
-        const char* path;
-        std::vector<byte> buf(DEFAULT_BUFFER_SIZE);
-        size_t parse_result = 0;
-        int minor_version;
-        struct phr_header headers[MAX_HEADERS];
-        size_t buflen = 0, prevbuflen = 0, method_len, path_len, num_headers;
-        
-        while (parse_result <= 0) {
-            // Check if we've exceeded max request size
-            if (prevbuflen >= maxRequestSize) {
-                if (logger) {
-                    logger->println("[HTTP] Request too large");
-                }
-                HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
-                respondToClient(client, response);
-                return false;
-            }
-            
-            byte tmpBuf[DEFAULT_BUFFER_SIZE];
-            int read_result = client.read(tmpBuf, DEFAULT_BUFFER_SIZE);
-            
-            if (read_result == -1) {
-                if (logger) {
-                    logger->println("[HTTP] Read error");
-                }
-                return false;
-            } else if (read_result == 0) {
-                return false;
+        int read_result = connection->receive(connection->readLimit > 0 ? connection->readLimit : maxRequestSize);
+        if (read_result < 0) {
+            if (logger) {
+                logger->println("[HTTP] Read error");
             }
+            return false;
+        }
+    }
 
-            buflen = read_result;
-            
-            // Bounds check before resizing
-            if (buflen + prevbuflen > maxRequestSize) {
-                if (logger) {
-                    logger->println("[HTTP] Request exceeds max size");
-                }
-                HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
-                respondToClient(client, response);
-                return false;
-            }
-            
-            // Extend buffer if needed
-            if (buflen + prevbuflen > buf.size()) {
-                size_t newSize = prevbuflen + buflen;
-                if (newSize > maxRequestSize) {
-                    newSize = maxRequestSize;
-                }
-                buf.resize(newSize);
-            }
-            
-            // Append to buffer
-            memcpy(buf.data() + prevbuflen, tmpBuf, buflen);
-            buflen = buflen + prevbuflen;
-
-            // Parse the request
-            num_headers = MAX_HEADERS;
-            const char* buf_char = reinterpret_cast<const char*>(buf.data());
-            parse_result = phr_parse_request(buf_char, buflen, &method, &method_len, 
-                                            &path, &path_len, &minor_version, 
-                                            headers, &num_headers, prevbuflen);
-            
+    // Answer every complete request in the receive buffer, in order (HTTP/1.1 pipelining)
+    while (connection->bufferedLength() > 0) {
+        size_t buflen = connection->bufferedLength();
+        const char* buf_char = reinterpret_cast<const char*>(connection->buffer());
+
+        if (!connection->headersComplete) {
+            // Resume the header scan where the previous tick left off
+            connection->numHeaders = MAX_HEADERS;
+            int minor_version;
+            int parse_result = phr_parse_request(buf_char, buflen, &connection->method, &connection->methodLength,
+                                                 &connection->path, &connection->pathLength, &minor_version,
+                                                 connection->headers, &connection->numHeaders, connection->parsedLength);
             if (parse_result == -1) {
+                // The parser stops with every header slot filled when a request has too many
+                if (connection->numHeaders == MAX_HEADERS) {
+                    if (logger) {
+                        logger->println("[HTTP] Too many headers");
+                    }
+                    HubHttpResponse response = generateErrorResponse(431, "Request Header Fields Too Large");
+                    respondToClient(connection, response);
+                    return false;
+                }
                 if (logger) {
                     logger->println("[HTTP] Parse error");
                 }
                 HubHttpResponse response = generateErrorResponse(400, "Bad Request");
-                respondToClient(client, response);
+                respondToClient(connection, response);
                 return false;
             } else if (parse_result == -2) {
-                // Incomplete request, continue reading
-                prevbuflen = buflen;
-                continue;
-            } else {
+                // Check if we've exceeded max request size
+                if (buflen >= maxRequestSize) {
+                    if (logger) {
+                        logger->println("[HTTP] Request too large");
+                    }
+                    HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
+                    respondToClient(connection, response);
+                    return false;
+                }
+                // Headers must be complete within clientTimeout of the first byte
+                if (millis() - connection->requestStartMillis > clientTimeout) {
+                    if (logger) {
+                        logger->println("[HTTP] Timed out waiting for request headers");
+                    }
+                    HubHttpResponse response = generateErrorResponse(408, "Request Timeout");
+                    respondToClient(connection, response);
+                    return false;
+                }
+                // A partial request stays buffered until more of it arrives on a later tick
+                connection->parsedLength = buflen;
+                connection->readLimit = maxRequestSize;
                 break;
             }
+            connection->headersComplete = true;
+            connection->headerLength = static_cast<size_t>(parse_result);
         }
 
-        if (parse_result <= 0) {
-            return false;
-        }
-
-        // Extract request body
-        String body = "";
-        if (static_cast<size_t>(parse_result) < buflen) {
-            size_t bodyLen = buflen - parse_result;
-            if (bodyLen > 0) {
-                body = String(reinterpret_cast<const char*>(buf.data()) + parse_result);
-            }
-        }
-
-        // Build HttpRequest object
+        // Build HttpRequest as a set of views into the receive buffer
         HttpRequest req;
-        req.method = String(method, method_len);
-        req.body = body;
+        const char* path = connection->path;
+        size_t path_len = connection->pathLength;
+        req.methodView = HttpSlice(connection->method, connection->methodLength);
+        req.methodId = httpMethodFromName(connection->method, connection->methodLength);
         
-        // Parse path and query string
-        std::string full_path = std::string(path, path_len);
-        size_t queryPos = full_path.find('?');
-        
-        if (queryPos != std::string::npos) {
-            req.path = String(full_path.substr(0, queryPos).c_str());
-            
-            // Parse query parameters
-            std::string query_string = full_path.substr(queryPos + 1);
-            std::vector<std::string> query_pairs = split(query_string, '&');
-            for (size_t i = 0; i < query_pairs.size(); i++) {
-                std::vector<std::string> key_value = split(query_pairs[i], '=');
-                if (key_value.size() == 2) {
-                    req.query[String(key_value[0].c_str())] = String(key_value[1].c_str());
-                } else if (key_value.size() == 1) {
-                    req.query[String(key_value[0].c_str())] = "";
-                }
-            }
+        // Split path and query string
+        const char* queryStart = static_cast<const char*>(memchr(path, '?', path_len));
+        if (queryStart != nullptr) {
+            req.pathView = HttpSlice(path, queryStart - path);
+            req.queryView = HttpSlice(queryStart + 1, path_len - (queryStart - path) - 1);
         } else {
-            req.path = String(path, path_len);
+            req.pathView = HttpSlice(path, path_len);
         }
         
         // Remove trailing slash (except for root)
-        if (req.path.length() > 1 && req.path.endsWith("/")) {
-            req.path.remove(req.path.length() - 1);
+        if (req.pathView.length > 1 && req.pathView.data[req.pathView.length - 1] == '/') {
+            req.pathView.length--;
         }
         
-        // Parse headers
-        for (size_t h = 0; h < num_headers; h++) {
-            String headerName = String(headers[h].name, headers[h].name_len);
-            String headerValue = String(headers[h].value, headers[h].value_len);
-            req.headers[headerName] = headerValue;
-            String lower = headerName; lower.toLowerCase();
-            req.headersLower[lower] = headerValue;
+        // Headers (picohttpparser reports continuation lines with a null name - skip them)
+        for (size_t h = 0; h < connection->numHeaders; h++) {
+            const struct phr_header &header = connection->headers[h];
+            if (header.name == nullptr) continue;
+            req.headerViews.add(HttpSlice(header.name, header.name_len), HttpSlice(header.value, header.value_len));
         }
 
-        logRequest(req);
-
-        // Create response
-        HubHttpResponse response;
-        
-        // Handle OPTIONS for CORS preflight
-        if (corsEnabled && req.method == "OPTIONS") {
-            response.setStatus(204);
-            applyCORS(response);
-            respondToClient(client, response);
-            return true;
-        }
-        
-        // Apply middlewares
-        applyMiddlewares(req, response);
-        
-        // Attempt param/method route matching first
-        bool routed = false;
-        for (size_t r = 0; r < patternHandlers.size(); r++) {
-            if (matchPattern(patternHandlers[r], req.method, req.path, req)) {
-                try {
-                    response = patternHandlers[r].handler(req);
-                } catch (...) {
-                    if (logger) logger->println("[HTTP] Handler threw exception");
-                    response = generateErrorResponse(500, "Internal Server Error");
+        size_t headerLen = connection->headerLength;
+        size_t bodyLen = 0;
+        bool bodyComplete = true;
+        size_t readLimit = maxRequestSize;
+
+        // Resolve the route once the headers are in - it decides how much body is allowed and how it is read.
+        // Later ticks (body still arriving) and dispatchRequest() reuse the match instead of walking the router again.
+        if (!connection->routeChecked) {
+            resolveRoute(connection, req);
+            if (connection->route >= 0) {
+                const RouteLimits &limits = routes[connection->route].limits;
+                size_t contentLength = 0;
+                if (limits.maxHeaders > 0 && req.headerViews.size() > limits.maxHeaders) {
+                    if (logger) {
+                        logger->println("[HTTP] Too many headers for route");
+                    }
+                    HubHttpResponse response = generateErrorResponse(431, "Request Header Fields Too Large");
+                    respondToClient(connection, response);
+                    return false;
+                }
+                if (limits.maxBodySize > 0 && req.headerViews.contentLength(contentLength) && contentLength > limits.maxBodySize) {
+                    if (logger) {
+                        logger->println("[HTTP] Request body exceeds route limit");
+                    }
+                    HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
+                    respondToClient(connection, response);
+                    return false;
                 }
-                routed = true;
-                break;
             }
+        } else {
+            connection->restoreRouteMatch(req);
         }
-
-        if (!routed && httpHandlers.find(req.path) != httpHandlers.end()) {
-            try {
-                response = httpHandlers[req.path](req);
-            } catch (...) {
-                if (logger) logger->println("[HTTP] Handler threw exception");
-                response = generateErrorResponse(500, "Internal Server Error");
+        const RouteLimits *limits = connection->route >= 0 ? &routes[connection->route].limits : nullptr;
+        size_t maxBodySize = limits != nullptr ? limits->maxBodySize : 0; // 0 = no per-route limit
+
+        // Streaming upload routes take the body piece by piece instead of buffering it
+        RoutePattern *streamRoute = connection->route >= 0 && routes[connection->route].bodyHandler ? &routes[connection->route] : nullptr;
+
+        if (req.getHeaderView(HTTP_HEADER_TRANSFER_ENCODING).containsIgnoreCase("chunked")) {
+            // Chunked body - decode in place as it arrives, so the decoded body always directly follows the headers
+            if (!connection->chunkedActive) {
+                memset(&connection->chunkedDecoder, 0, sizeof(connection->chunkedDecoder));
+                connection->chunkedDecoder.consume_trailer = 1;
+                connection->chunkedActive = true;
+                connection->chunkedLength = 0;
+                connection->chunkedDone = false;
+            }
+            if (!connection->chunkedDone) {
+                size_t decodedEnd = headerLen + connection->chunkedLength;
+                size_t rawLen = buflen - decodedEnd;
+                ssize_t decode_result = phr_decode_chunked(&connection->chunkedDecoder,
+                                                           reinterpret_cast<char*>(connection->buffer()) + decodedEnd, &rawLen);
+                if (decode_result == -1) {
+                    if (logger) {
+                        logger->println("[HTTP] Invalid chunked body");
+                    }
+                    HubHttpResponse response = generateErrorResponse(400, "Bad Request");
+                    respondToClient(connection, response);
+                    return false;
+                }
+                connection->chunkedLength += rawLen;
+                if (decode_result == -2) {
+                    // Everything received so far is decoded - new data is appended right after it
+                    connection->truncate(headerLen + connection->chunkedLength);
+                    bodyComplete = false;
+                } else {
+                    // Bytes after the terminating chunk (the next pipelined request) were moved down to follow the body
+                    connection->truncate(headerLen + connection->chunkedLength + static_cast<size_t>(decode_result));
+                    connection->chunkedDone = true;
+                }
+            }
+            if (maxBodySize > 0 && connection->streamedLength + connection->chunkedLength > maxBodySize) {
+                if (logger) {
+                    logger->println("[HTTP] Chunked request body exceeds route limit");
+                }
+                HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
+                respondToClient(connection, response);
+                return false;
+            }
+            if (streamRoute != nullptr) {
+                if (connection->chunkedLength > 0) {
+                    if (!streamRoute->bodyHandler(req, connection->buffer() + headerLen, connection->chunkedLength)) {
+                        HubHttpResponse response = generateErrorResponse(400, "Upload Aborted");
+                        respondToClient(connection, response);
+                        return false;
+                    }
+                    connection->erase(headerLen, connection->chunkedLength);
+                    connection->streamedLength += connection->chunkedLength;
+                    connection->chunkedLength = 0;
+                }
+                readLimit = headerLen + DEFAULT_BUFFER_SIZE;
+            } else if (headerLen + connection->chunkedLength >= maxRequestSize && !bodyComplete) {
+                if (logger) {
+                    logger->println("[HTTP] Chunked request body exceeds max size");
+                }
+                HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
+                respondToClient(connection, response);
+                return false;
+            }
+            bodyLen = connection->chunkedLength;
+        } else {
+            // The body runs for exactly Content-Length bytes - anything after it is the next pipelined request
+            size_t contentLength = 0;
+            req.headerViews.contentLength(contentLength);
+            if (req.headerViews.hasInvalidContentLength()) {
+                if (logger) {
+                    logger->println("[HTTP] Invalid Content-Length");
+                }
+                HubHttpResponse response = generateErrorResponse(400, "Bad Request");
+                respondToClient(connection, response);
+                return false;
             }
-            routed = true;
-        }
-
-        if (!routed && req.path == "/") {
-            // Default root handler
-            String html = "<html><head><title>" + serverName + "</title></head>";
-            html += "<body><h1>Hello!</h1><h3>You're connected to " + serverName + "!</h3>";
-            html += "<p>Version: " + serverVersion + "</p></body></html>";
-            response.html(html);
-            routed = true;
-        } else if (!routed && req.path == "/log") {
-            // Built-in log endpoint
-            if (logger == nullptr) {
-                response = generateErrorResponse(404, "Logging not enabled");
+            if (streamRoute != nullptr) {
+                size_t remaining = contentLength - connection->streamedLength;
+                size_t available = buflen - headerLen;
+                size_t piece = available < remaining ? available : remaining;
+                if (piece > 0) {
+                    if (!streamRoute->bodyHandler(req, connection->buffer() + headerLen, piece)) {
+                        HubHttpResponse response = generateErrorResponse(400, "Upload Aborted");
+                        respondToClient(connection, response);
+                        return false;
+                    }
+                    connection->erase(headerLen, piece);
+                    connection->streamedLength += piece;
+                    remaining -= piece;
+                }
+                bodyComplete = remaining == 0;
+                readLimit = headerLen + (remaining < DEFAULT_BUFFER_SIZE ? remaining : DEFAULT_BUFFER_SIZE);
             } else {
-                size_t num_lines = 20;
-                if (req.hasQueryParam("lines")) {
-                    num_lines = req.getQueryParam("lines").toInt();
-                    if (num_lines == 0) num_lines = 20;
+                if (contentLength > maxRequestSize || headerLen + contentLength > maxRequestSize) {
+                    if (logger) {
+                        logger->println("[HTTP] Request body exceeds max size");
+                    }
+                    HubHttpResponse response = generateErrorResponse(413, "Payload Too Large");
+                    respondToClient(connection, response);
+                    return false;
                 }
-                String log_tail = logger->tail(num_lines).c_str();
-                response.text(log_tail);
+                bodyLen = contentLength;
+                bodyComplete = buflen - headerLen >= bodyLen;
+                readLimit = headerLen + bodyLen;
             }
-            routed = true;
         }
-
-        if (!routed) {
-            // Not found
-            if (notFoundHandler) {
-                response = notFoundHandler(req);
-            } else {
-                response = generateErrorResponse(404, "Not Found");
+        if (!bodyComplete) {
+            // Body still arriving - tell clients waiting on "Expect: 100-continue" to go ahead
+            if (!connection->continueSent && req.getHeaderView(HTTP_HEADER_EXPECT).equalsIgnoreCase("100-continue")) {
+                static const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+                connection->send(reinterpret_cast<const uint8_t*>(CONTINUE_RESPONSE), sizeof(CONTINUE_RESPONSE) - 1);
+                connection->continueSent = true;
+            }
+            // The body must keep flowing (and finish within the route's deadline, if it has one)
+            bool pastDeadline = limits != nullptr && limits->readDeadline > 0 &&
+                                millis() - connection->requestStartMillis > limits->readDeadline;
+            if (pastDeadline || millis() - connection->lastReceiveMillis > clientTimeout) {
+                if (logger) {
+                    logger->println("[HTTP] Timed out waiting for request body");
+                }
+                HubHttpResponse response = generateErrorResponse(408, "Request Timeout");
+                respondToClient(connection, response);
+                return false;
             }
+            connection->readLimit = readLimit;
+            break; // keep what we have and pick up the rest next tick
         }
-        
-        // Apply CORS headers
-        if (corsEnabled) {
-            applyCORS(response);
+        if (bodyLen > 0) {
+            req.bodyView = HttpSlice(buf_char + headerLen, bodyLen);
         }
-        
-        // Add server header
-        if (!response.headers.count("Server")) {
-            response.setHeader("Server", serverName + "/" + serverVersion);
-        }
-        // Apply default headers
-        applyDefaultHeaders(response);
-        // Keep-Alive / Connection header
-        if (keepAlive) {
-            response.setHeader("Connection", "keep-alive");
-        } else {
-            response.setHeader("Connection", "close");
+
+        bool keepOpen = dispatchRequest(connection, req);
+        connection->updateActivity();
+        if (!keepOpen) {
+            return false; // client sent "Connection: close"
         }
-        // Final hook
-        if (beforeSendHook) {
-            beforeSendHook(req, response);
+
+        // Drop the handled request (the views above are invalid from here on)
+        connection->consume(headerLen + bodyLen);
+
+        // Pipelined requests wait until the client has taken this response
+        if (connection->hasPendingOutput() || connection->closeAfterSend) {
+            break;
         }
-        
-        // Send response
-        logResponse(response);
-        respondToClient(client, response);
-        
-        connection->updateActivity();
     }
 
     return true;
 }
 
-bool HttpServer::respondToClient(WiFiClient& client, HubHttpResponse& response) {
-    // Build status line
-    String statusLine = "HTTP/1.1 " + String(response.status) + " " + getStatusText(response.status);
-    client.println(statusLine);
-    
-    // Write headers
-    for (std::map<String, String>::const_iterator it = response.headers.begin(); 
-         it != response.headers.end(); ++it) {
-        client.print(it->first);
-        client.print(": ");
-        client.println(it->second);
+int HttpServer::findRoute(HttpRequest &req, int *pathMatch) const {
+    return router.find(req, pathMatch);
+}
+
+void HttpServer::resolveRoute(HttpClientConnection *connection, HttpRequest &req) const {
+    // The compile-time table first, then one walk of the route tree. Compile-time routes have no
+    // limits, streaming or middleware of their own.
+    connection->pathMatch = -1;
+    connection->staticRoute = staticFind != nullptr ? staticFind(req) : -1;
+    connection->route = connection->staticRoute < 0 ? findRoute(req, &connection->pathMatch) : HttpRouter::NO_ROUTE;
+    connection->saveRouteMatch(req);
+    connection->routeChecked = true;
+}
+
+void HttpServer::invokeRoute(const RoutePattern &rp, HttpRequest &req, HubHttpResponse &response) {
+    if (rp.handlerFn != nullptr) {
+        rp.handlerFn(req, response, rp.handlerContext);
+    } else if (rp.fillHandler) {
+        rp.fillHandler(req, response);
+    } else {
+        response = rp.handler(req);
     }
+}
+
+bool HttpServer::dispatchRequest(HttpClientConnection* connection, HttpRequest &req) {
+    logRequest(req);
 
-    // Calculate and send Content-Length
-    size_t total_bytes = utf8ByteLength(response.body);
-    client.print("Content-Length: ");
-    client.println(String(total_bytes));
-    client.println();
+    // Create response
+    HubHttpResponse response;
     
-    // Send body in chunks
-    if (total_bytes > 0) {
-        size_t bytes_written = 0;
-        unsigned long start = millis();
-        
-        while (bytes_written < total_bytes) {
-            // Check timeout
-            if (millis() - start > WRITE_TIMEOUT_MS) {
-                if (logger) {
-                    logger->println("[HTTP] Write timeout");
-                }
-                return false;
-            }
-            
-            // Calculate chunk size
-            size_t remaining = total_bytes - bytes_written;
-            size_t chunk_size = (remaining < WRITE_CHUNK_SIZE) ? remaining : WRITE_CHUNK_SIZE;
-            
-            // Write chunk
-            size_t written = client.write(
-                reinterpret_cast<const uint8_t*>(response.body.c_str()) + bytes_written, 
-                chunk_size
-            );
-            
-            if (written == 0) {
-                if (logger) {
-                    logger->println("[HTTP] Write error");
-                }
-                return false;
+    // Handle OPTIONS for CORS preflight
+    if (corsEnabled && req.methodId == HTTP_METHOD_OPTIONS) {
+        response.setStatus(204);
+        applyCORS(response);
+        respondToClient(connection, response);
+        return !req.headerViews.connectionClose();
+    }
+    
+    // The route was resolved when the headers completed (handleConnection)
+    int pathMatch = connection->pathMatch;
+    int staticRoute = connection->staticRoute;
+    int route = connection->route;
+    RoutePattern *rp = route != HttpRouter::NO_ROUTE ? &routes[route] : nullptr;
+
+    // Only copy the request into owned Strings when the handler expects them
+    if (!zeroCopyRequests) {
+        req.materialize();
+    }
+
+    // Global middlewares, then the route's own chain (resolved when it was registered)
+    bool routed = !applyMiddlewares(req, response, middlewares) ||
+                  (rp != nullptr && !applyMiddlewares(req, response, rp->middlewares));
+    if (routed) {
+        rp = nullptr; // a middleware short-circuited - send its response
+        staticRoute = -1;
+        pathMatch = -1;
+    }
+
+    // A cached response is sent exactly as stored, without calling the handler
+    bool clientClose = req.headerViews.connectionClose();
+    bool cacheable = rp != nullptr && rp->cache.ttl > 0 && req.methodId == HTTP_METHOD_GET &&
+                     req.getHeaderView(HTTP_HEADER_IF_NONE_MATCH).empty();
+    String cacheKey;
+    if (cacheable) {
+        cacheKey = responseCacheKey(req, rp->cache, keepAlive && !clientClose);
+        const ResponseCacheEntry *entry = findCachedResponse(route, cacheKey);
+        if (entry != nullptr) {
+            if (debug && logger) {
+                logger->println("[HTTP] Response: cached");
             }
-            
-            bytes_written += written;
-            
-            // Small yield to prevent watchdog issues
-            if (bytes_written < total_bytes) {
-                delay(1);
+            connection->send(entry->data.data(), entry->data.size());
+            return !clientClose;
+        }
+    }
+
+    if (rp != nullptr || staticRoute >= 0) {
+        try {
+            if (staticRoute >= 0) {
+                staticInvoke(staticRoute, req, response);
+            } else {
+                invokeRoute(*rp, req, response);
             }
+        } catch (...) {
+            if (logger) logger->println("[HTTP] Handler threw exception");
+            response = generateErrorResponse(500, "Internal Server Error");
+        }
+        routed = true;
+    } else if (pathMatch >= 0) {
+        // The path is routed, just not for this method
+        response = generateErrorResponse(405, "Method Not Allowed");
+        response.setHeader("Allow", router.allowedMethods(pathMatch));
+        routed = true;
+    }
+
+    if (!routed && req.pathView.equals("/")) {
+        // Default root handler
+        String html = "<html><head><title>" + serverName + "</title></head>";
+        html += "<body><h1>Hello!</h1><h3>You're connected to " + serverName + "!</h3>";
+        html += "<p>Version: " + serverVersion + "</p></body></html>";
+        response.html(html);
+        routed = true;
+    } else if (!routed && req.pathView.equals("/log")) {
+        // Built-in log endpoint
+        if (logger == nullptr) {
+            response = generateErrorResponse(404, "Logging not enabled");
+        } else {
+            long num_lines = req.getQueryParamInt("lines", 20);
+            if (num_lines <= 0) num_lines = 20;
+            String log_tail = logger->tail(num_lines).c_str();
+            response.text(log_tail);
+        }
+        routed = true;
+    }
+
+    if (!routed) {
+        // Not found
+        if (notFoundHandler) {
+            response = notFoundHandler(req);
+        } else {
+            response = generateErrorResponse(404, "Not Found");
         }
     }
     
-    return true;
+    // Apply CORS headers
+    if (corsEnabled) {
+        applyCORS(response);
+    }
+    
+    // Add server header
+    if (!response.headers.count("Server")) {
+        response.setHeader("Server", serverName + "/" + serverVersion);
+    }
+    // Apply default headers
+    applyDefaultHeaders(response);
+    // Keep-Alive / Connection header (a client asking to close always wins)
+    if (keepAlive && !clientClose) {
+        response.setHeader("Connection", "keep-alive");
+    } else {
+        response.setHeader("Connection", "close");
+    }
+    // Final hook
+    if (beforeSendHook) {
+        beforeSendHook(req, response);
+    }
+    
+    // Conditional GET (after the hook, so ETags it sets are honoured)
+    applyConditionalResponse(req, response);
+
+    // Send response
+    logResponse(response);
+    if (cacheable && response.status == 200 && !response.isStreaming()) {
+        const ResponseCacheEntry *entry = storeCachedResponse(route, cacheKey, response);
+        if (entry != nullptr) {
+            connection->send(entry->data.data(), entry->data.size());
+            return !clientClose;
+        }
+    }
+    respondToClient(connection, response, req.methodId == HTTP_METHOD_HEAD);
+    return !clientClose;
+}
+
+String HttpServer::responseCacheKey(const HttpRequest &req, const ResponseCachePolicy &policy, bool keepOpen) const {
+    // The Connection header is part of the stored bytes, so keep-alive and close get separate entries
+    String key = keepOpen ? "k" : "c";
+    key += req.pathView.toString();
+    for (size_t i = 0; i < policy.varyQuery.size(); i++) {
+        key += '\n';
+        key += req.getQueryParamView(policy.varyQuery[i].c_str()).toString();
+    }
+    for (size_t i = 0; i < policy.varyHeaders.size(); i++) {
+        key += '\n';
+        key += req.getHeaderView(policy.varyHeaders[i].c_str()).toString();
+    }
+    return key;
+}
+
+const HttpServer::ResponseCacheEntry* HttpServer::findCachedResponse(int route, const String &key) {
+    for (size_t i = 0; i < responseCache.size(); i++) {
+        ResponseCacheEntry &entry = responseCache[i];
+        if (entry.route != route || entry.key != key) {
+            continue;
+        }
+        if (millis() - entry.storedMillis >= routes[route].cache.ttl) {
+            responseCacheBytes -= entryCost(entry);
+            responseCache.erase(responseCache.begin() + i);
+            break; // expired
+        }
+        entry.lastUsed = ++responseCacheClock;
+        responseCacheHits++;
+        return &entry;
+    }
+    responseCacheMisses++;
+    return nullptr;
+}
+
+const HttpServer::ResponseCacheEntry* HttpServer::storeCachedResponse(int route, const String &key, const HubHttpResponse &response) {
+    const uint8_t *body;
+    size_t length;
+    if (response.bodyData != nullptr) {
+        body = response.bodyData;
+        length = response.bodyLength > 0 ? static_cast<size_t>(response.bodyLength) : 0;
+    } else {
+        body = reinterpret_cast<const uint8_t*>(response.body.c_str());
+        length = utf8ByteLength(response.body);
+    }
+
+    ResponseCacheEntry entry;
+    entry.route = route;
+    entry.key = key;
+    serializeHead(response, length, entry.data);
+    // Sized before the body is copied, so a response that can never fit costs no second copy
+    size_t cost = entryCost(entry) + length;
+    if (cost > responseCacheBudget) {
+        return nullptr;
+    }
+    entry.data.reserve(entry.data.size() + length);
+    entry.data.insert(entry.data.end(), body, body + length);
+    entry.storedMillis = millis();
+    entry.lastUsed = ++responseCacheClock;
+
+    evictResponseCacheUntil(responseCacheBudget - cost);
+    responseCacheBytes += cost;
+    responseCache.push_back(std::move(entry));
+    return &responseCache.back();
+}
+
+size_t HttpServer::entryCost(const ResponseCacheEntry &entry) {
+    return entry.data.size() + entry.key.length() + sizeof(ResponseCacheEntry);
+}
+
+void HttpServer::evictResponseCacheUntil(size_t budget) {
+    // Least recently used first
+    while (responseCacheBytes > budget && !responseCache.empty()) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < responseCache.size(); i++) {
+            if (responseCache[i].lastUsed < responseCache[oldest].lastUsed) oldest = i;
+        }
+        responseCacheBytes -= entryCost(responseCache[oldest]);
+        responseCache.erase(responseCache.begin() + oldest);
+    }
+}
+
+void HttpServer::dropCachedResponses(int route) {
+    for (size_t i = 0; i < responseCache.size(); ) {
+        if (route < 0 || responseCache[i].route == route) {
+            responseCacheBytes -= entryCost(responseCache[i]);
+            responseCache.erase(responseCache.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+static void appendBytes(std::vector<uint8_t> &out, const char *data, size_t length) {
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(data) + length);
+}
+
+static void appendBytes(std::vector<uint8_t> &out, const String &str) {
+    appendBytes(out, str.c_str(), str.length());
+}
+
+static void appendDecimal(std::vector<uint8_t> &out, size_t value) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        out.push_back(static_cast<uint8_t>(digits[--n]));
+    }
+}
+
+void HttpServer::serializeHead(const HubHttpResponse &response, size_t contentLength, std::vector<uint8_t> &out) {
+    appendBytes(out, "HTTP/1.1 ", 9);
+    appendDecimal(out, static_cast<size_t>(response.status));
+    out.push_back(' ');
+    appendBytes(out, getStatusText(response.status));
+    appendBytes(out, "\r\n", 2);
+
+    for (std::map<String, String>::const_iterator it = response.headers.begin();
+         it != response.headers.end(); ++it) {
+        appendBytes(out, it->first);
+        appendBytes(out, ": ", 2);
+        appendBytes(out, it->second);
+        appendBytes(out, "\r\n", 2);
+    }
+
+    if (response.status == 304) {
+        // Not Modified has no body, and a Content-Length would describe the full representation
+        appendBytes(out, "\r\n", 2);
+    } else if (response.isStreaming() && response.bodyLength < 0) {
+        appendBytes(out, "Transfer-Encoding: chunked\r\n\r\n", 30);
+    } else {
+        appendBytes(out, "Content-Length: ", 16);
+        appendDecimal(out, contentLength);
+        appendBytes(out, "\r\n\r\n", 4);
+    }
+}
+
+void HttpServer::respondToClient(HttpClientConnection *connection, HubHttpResponse& response, bool headOnly) {
+    if (response.isStreaming()) {
+        // Only the head is built here - the body is generated chunk by chunk as the client reads it
+        sendBuffer.clear();
+        size_t length = response.bodyLength > 0 ? static_cast<size_t>(response.bodyLength) : 0;
+        serializeHead(response, length, sendBuffer);
+        connection->send(sendBuffer.data(), sendBuffer.size());
+        if (response.bodyLength != 0 && !headOnly) {
+            connection->send(response.bodyGenerator, response.bodyLength);
+        }
+        return;
+    }
+
+    size_t total_bytes;
+    const uint8_t *body;
+    if (response.bodyData != nullptr) {
+        total_bytes = response.bodyLength > 0 ? static_cast<size_t>(response.bodyLength) : 0;
+        body = response.bodyData;
+    } else {
+        total_bytes = utf8ByteLength(response.body);
+        body = reinterpret_cast<const uint8_t*>(response.body.c_str());
+    }
+    if (headOnly) {
+        // HEAD: the same headers (Content-Length included) as for GET, no body
+        sendBuffer.clear();
+        serializeHead(response, total_bytes, sendBuffer);
+        connection->send(sendBuffer.data(), sendBuffer.size());
+        return;
+    }
+
+    // Gather the status line, headers and as much of the body as fits in one segment,
+    // so small responses leave in a single write instead of one per header line
+    if (sendBuffer.capacity() < SEND_BUFFER_SIZE) {
+        sendBuffer.reserve(SEND_BUFFER_SIZE);
+    }
+    sendBuffer.clear();
+    serializeHead(response, total_bytes, sendBuffer);
+    size_t bodyInBuffer = 0;
+    if (sendBuffer.size() < SEND_BUFFER_SIZE) {
+        bodyInBuffer = SEND_BUFFER_SIZE - sendBuffer.size();
+        if (bodyInBuffer > total_bytes) {
+            bodyInBuffer = total_bytes;
+        }
+        sendBuffer.insert(sendBuffer.end(), body, body + bodyInBuffer);
+    }
+
+    // Whatever the socket cannot take now is queued and sent by tick()
+    connection->send(sendBuffer.data(), sendBuffer.size());
+    if (bodyInBuffer < total_bytes) {
+        if (response.bodyData != nullptr) {
+            connection->sendStatic(body + bodyInBuffer, total_bytes - bodyInBuffer);
+        } else {
+            connection->send(std::move(response.body), bodyInBuffer);
+        }
+    }
 }
 
 // ============================================================================
 // HttpRequest Implementation
 // ============================================================================
 
-HttpRequest::HttpRequest() {
+static int hexDigitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Produce the next decoded character of a query component ('+' -> space, %XX -> byte)
+static bool nextDecodedChar(const char *&p, const char *end, char &out) {
+    if (p >= end) {
+        return false;
+    }
+    if (*p == '+') {
+        out = ' ';
+        p++;
+    } else if (*p == '%' && end - p >= 3 && hexDigitValue(p[1]) >= 0 && hexDigitValue(p[2]) >= 0) {
+        out = static_cast<char>((hexDigitValue(p[1]) << 4) | hexDigitValue(p[2]));
+        p += 3;
+    } else {
+        out = *p++; // malformed escapes are kept literally
+    }
+    return true;
+}
+
+static bool decodedEquals(const HttpSlice &raw, const char *str, size_t strLen) {
+    const char *p = raw.data;
+    const char *end = raw.data + raw.length;
+    size_t i = 0;
+    char c;
+    while (nextDecodedChar(p, end, c)) {
+        if (i >= strLen || str[i] != c) {
+            return false;
+        }
+        i++;
+    }
+    return i == strLen;
+}
+
+static String decodeQueryComponent(const HttpSlice &raw) {
+    String result;
+    result.reserve(raw.length);
+    const char *p = raw.data;
+    const char *end = raw.data + raw.length;
+    char c;
+    while (nextDecodedChar(p, end, c)) {
+        result += c;
+    }
+    return result;
+}
+
+HttpRequest::HttpRequest() : methodId(HTTP_METHOD_GET), numParamViews(0), numQueryParams(0), queryParsed(false), queryRest(nullptr) {
     method = "GET";
     path = "/";
     body = "";
+    methodView = HttpSlice("GET", 3);
+    pathView = HttpSlice("/", 1);
 }
 
-bool HttpRequest::jsonRequested() const {
-    // Check Accept header
-    String accept = getHeader("Accept");
-    if (accept.length() > 0) {
-        accept.toLowerCase();
-        if (accept.indexOf("application/json") != -1 || accept.indexOf("json") != -1) {
-            return true;
+void HttpRequest::materialize() {
+    method = methodView.toString();
+    path = pathView.toString();
+    body = bodyView.toString();
+
+    headers.clear();
+    for (size_t h = 0; h < headerViews.size(); h++) {
+        headers[headerViews[h].name.toString()] = headerViews[h].value.toString();
+    }
+
+    query.clear();
+    parseQuery();
+    const char *rest = queryRest;
+    const char *queryEnd = queryView.data + queryView.length;
+    HttpQueryParamSlice extra;
+    for (size_t i = 0; i < numQueryParams || nextQueryParam(rest, queryEnd, extra); i++) {
+        const HttpQueryParamSlice &qp = i < numQueryParams ? queryParams[i] : extra;
+        if (qp.encoded) {
+            query[decodeQueryComponent(qp.name)] = decodeQueryComponent(qp.value);
+        } else {
+            query[qp.name.toString()] = qp.value.toString();
         }
     }
-    
-    // Check query parameter
-    String jsonParam = getQueryParam("json");
-    if (jsonParam.length() > 0) {
-        jsonParam.toLowerCase();
-        if (jsonParam == "true" || jsonParam == "1" || jsonParam == "yes") {
+
+    params.clear();
+    for (size_t i = 0; i < numParamViews; i++) {
+        params[paramViews[i].name.toString()] = paramViews[i].value.toString();
+    }
+}
+
+HttpSlice HttpRequest::getHeaderView(const char *name) const {
+    const HttpHeaderSlice *header = headerViews.find(name);
+    return header != nullptr ? header->value : HttpSlice();
+}
+
+HttpSlice HttpRequest::getHeaderView(HttpHeaderId id) const {
+    const HttpHeaderSlice *header = headerViews.get(id);
+    return header != nullptr ? header->value : HttpSlice();
+}
+
+bool HttpRequest::nextQueryParam(const char *&p, const char *end, HttpQueryParamSlice &qp) {
+    // Split on '&' and the first '=', noting which pieces need decoding
+    while (p < end) {
+        const char *nameStart = p;
+        const char *eq = nullptr;
+        bool encoded = false;
+        while (p < end && *p != '&') {
+            if (*p == '=' && eq == nullptr) {
+                eq = p;
+            } else if (*p == '%' || *p == '+') {
+                encoded = true;
+            }
+            p++;
+        }
+        const char *nameEnd = eq != nullptr ? eq : p;
+        const char *valueEnd = p;
+        if (p < end) {
+            p++; // skip '&'
+        }
+        if (nameEnd > nameStart) {
+            qp.name = HttpSlice(nameStart, nameEnd - nameStart);
+            qp.value = eq != nullptr ? HttpSlice(eq + 1, valueEnd - eq - 1) : HttpSlice(valueEnd, 0);
+            qp.encoded = encoded;
             return true;
         }
     }
-    
     return false;
 }
 
-String HttpRequest::getHeader(const String &name, const String &defaultValue) const {
-    String lowerName = name; lowerName.toLowerCase();
-    std::map<String,String>::const_iterator it = headersLower.find(lowerName);
-    if (it != headersLower.end()) return it->second;
-    return defaultValue;
+void HttpRequest::parseQuery() const {
+    if (queryParsed) {
+        return;
+    }
+    queryParsed = true;
+    numQueryParams = 0;
+
+    // Single pass over the first MAX_QUERY_PARAMS pairs
+    const char *p = queryView.data;
+    const char *end = queryView.data + queryView.length;
+    while (numQueryParams < MAX_QUERY_PARAMS && nextQueryParam(p, end, queryParams[numQueryParams])) {
+        numQueryParams++;
+    }
+    queryRest = p;
 }
 
-String HttpRequest::getQueryParam(const String &name, const String &defaultValue) const {
-    std::map<String, String>::const_iterator it = query.find(name);
-    if (it != query.end()) {
-        return it->second;
+const HttpQueryParamSlice* HttpRequest::findQueryParam(const char *name) const {
+    parseQuery();
+    size_t nameLen = strlen(name);
+    for (size_t i = 0; i < numQueryParams; i++) {
+        const HttpQueryParamSlice &qp = queryParams[i];
+        if (qp.encoded ? decodedEquals(qp.name, name, nameLen) : qp.name.equals(name)) {
+            return &qp;
+        }
+    }
+    // Requests with more pairs than the table holds: scan the rest of the query string
+    const char *p = queryRest;
+    const char *end = queryView.data + queryView.length;
+    while (nextQueryParam(p, end, overflowParam)) {
+        const HttpQueryParamSlice &qp = overflowParam;
+        if (qp.encoded ? decodedEquals(qp.name, name, nameLen) : qp.name.equals(name)) {
+            return &qp;
+        }
+    }
+    return nullptr;
+}
+
+HttpSlice HttpRequest::getQueryParamView(const char *name) const {
+    const HttpQueryParamSlice *qp = findQueryParam(name);
+    return qp != nullptr ? qp->value : HttpSlice();
+}
+
+int HttpRequest::copyQueryParam(const char *name, char *out, size_t outSize) const {
+    const HttpQueryParamSlice *qp = findQueryParam(name);
+    if (qp == nullptr) {
+        return -1;
+    }
+    const char *p = qp->value.data;
+    const char *end = p + qp->value.length;
+    size_t len = 0;
+    char c;
+    while (nextDecodedChar(p, end, c)) {
+        if (len + 1 < outSize) {
+            out[len] = c;
+        }
+        len++;
+    }
+    if (outSize > 0) {
+        out[len < outSize ? len : outSize - 1] = '\0';
+    }
+    return static_cast<int>(len);
+}
+
+long HttpRequest::getQueryParamInt(const char *name, long defaultValue) const {
+    char buf[24];
+    int len = copyQueryParam(name, buf, sizeof(buf));
+    if (len <= 0 || len >= static_cast<int>(sizeof(buf))) {
+        return defaultValue;
+    }
+    char *endPtr;
+    long value = strtol(buf, &endPtr, 10);
+    return *endPtr == '\0' ? value : defaultValue;
+}
+
+float HttpRequest::getQueryParamFloat(const char *name, float defaultValue) const {
+    char buf[32];
+    int len = copyQueryParam(name, buf, sizeof(buf));
+    if (len <= 0 || len >= static_cast<int>(sizeof(buf))) {
+        return defaultValue;
+    }
+    char *endPtr;
+    float value = strtof(buf, &endPtr);
+    return *endPtr == '\0' ? value : defaultValue;
+}
+
+bool HttpRequest::getQueryParamBool(const char *name, bool defaultValue) const {
+    char buf[8];
+    int len = copyQueryParam(name, buf, sizeof(buf));
+    if (len < 0 || len >= static_cast<int>(sizeof(buf))) {
+        return defaultValue;
+    }
+    if (len == 0 || strcasecmp(buf, "true") == 0 || strcmp(buf, "1") == 0 ||
+        strcasecmp(buf, "yes") == 0 || strcasecmp(buf, "on") == 0) {
+        return true;
+    }
+    if (strcasecmp(buf, "false") == 0 || strcmp(buf, "0") == 0 ||
+        strcasecmp(buf, "no") == 0 || strcasecmp(buf, "off") == 0) {
+        return false;
     }
     return defaultValue;
 }
 
-bool HttpRequest::hasHeader(const String &name) const {
-    String lowerName = name; lowerName.toLowerCase();
-    return headersLower.find(lowerName) != headersLower.end();
-}
-
-bool HttpServer::matchPattern(const RoutePattern &rp, const String &method, const String &path, HttpRequest &req) {
-    if (!rp.method.equalsIgnoreCase(method)) return false;
-    String normPath = path;
-    if (normPath.length() > 1 && normPath.endsWith("/")) normPath.remove(normPath.length()-1);
-    // Split incoming path
-    std::vector<String> pathSegs;
-    int start = 0;
-    while (start < normPath.length()) {
-        int idx = normPath.indexOf('/', start);
-        if (idx == -1) idx = normPath.length();
-        String seg = normPath.substring(start, idx);
-        if (seg.length() > 0) pathSegs.push_back(seg);
-        start = idx + 1;
-    }
-    if (pathSegs.size() != rp.segments.size()) return false;
-    for (size_t i = 0; i < rp.segments.size(); i++) {
-        const String &patSeg = rp.segments[i];
-        const String &actSeg = pathSegs[i];
-        if (patSeg.startsWith(":")) {
-            String key = patSeg.substring(1);
-            req.params[key] = actSeg;
-        } else if (patSeg != actSeg) {
-            return false;
+HttpSlice HttpRequest::getParamView(const char *name) const {
+    for (size_t i = 0; i < numParamViews; i++) {
+        if (paramViews[i].name.equals(name)) {
+            return paramViews[i].value;
         }
     }
-    return true;
+    return HttpSlice();
+}
+
+String HttpRequest::getRemainingPath() const {
+    return remainingPathView.toString();
+}
+
+const uint8_t* HttpRequest::bodyData() const {
+    return reinterpret_cast<const uint8_t*>(bodyView.data);
+}
+
+size_t HttpRequest::bodyLength() const {
+    return bodyView.length;
+}
+
+String HttpRequest::getParam(const String &name, const String &defaultValue) const {
+    for (size_t i = 0; i < numParamViews; i++) {
+        if (paramViews[i].name.equals(name)) {
+            return paramViews[i].value.toString();
+        }
+    }
+    return defaultValue;
+}
+
+bool HttpRequest::jsonRequested() const {
+    // Check Accept header
+    if (getHeaderView(HTTP_HEADER_ACCEPT).containsIgnoreCase("json")) {
+        return true;
+    }
+    
+    // Check query parameter
+    HttpSlice jsonParam = getQueryParamView("json");
+    return jsonParam.equalsIgnoreCase("true") || jsonParam.equals("1") || jsonParam.equalsIgnoreCase("yes");
+}
+
+String HttpRequest::getHeader(const String &name, const String &defaultValue) const {
+    const HttpHeaderSlice *header = headerViews.find(name.c_str(), name.length());
+    return header != nullptr ? header->value.toString() : defaultValue;
+}
+
+String HttpRequest::getQueryParam(const String &name, const String &defaultValue) const {
+    const HttpQueryParamSlice *qp = findQueryParam(name.c_str());
+    if (qp == nullptr) {
+        return defaultValue;
+    }
+    return qp->encoded ? decodeQueryComponent(qp->value) : qp->value.toString();
+}
+
+bool HttpRequest::hasHeader(const String &name) const {
+    return getHeaderView(name.c_str()).data != nullptr;
 }
 
 bool HttpRequest::hasQueryParam(const String &name) const {
-    return query.find(name) != query.end();
+    return findQueryParam(name.c_str()) != nullptr;
 }
 
 String HttpRequest::getContentType() const {
-    return getHeader("Content-Type");
+    return getHeaderView(HTTP_HEADER_CONTENT_TYPE).toString();
 }
 
 bool HttpRequest::isContentType(const String &contentType) const {
-    String ct = getContentType();
-    ct.toLowerCase();
-    String checkType = contentType;
-    checkType.toLowerCase();
-    return ct.indexOf(checkType) != -1;
+    return getHeaderView(HTTP_HEADER_CONTENT_TYPE).containsIgnoreCase(contentType.c_str());
+}
+
+// ============================================================================
+// HttpHeaderTable Implementation
+// ============================================================================
+
+uint32_t HttpHeaderTable::hashName(const char *name, size_t len) {
+    // FNV-1a over the ASCII-lowercased name (header names are tokens, so OR-ing 0x20 is enough)
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= static_cast<uint8_t>(name[i] | 0x20);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+HttpHeaderId HttpHeaderTable::identify(const char *name, size_t len) {
+    // Switch on length + first letter so most names are rejected without a compare
+    switch (len) {
+        case 4:
+            if ((name[0] | 0x20) == 'h' && strncasecmp(name, "host", 4) == 0) return HTTP_HEADER_HOST;
+            break;
+        case 6:
+            if ((name[0] | 0x20) == 'a' && strncasecmp(name, "accept", 6) == 0) return HTTP_HEADER_ACCEPT;
+            if ((name[0] | 0x20) == 'e' && strncasecmp(name, "expect", 6) == 0) return HTTP_HEADER_EXPECT;
+            break;
+        case 10:
+            if ((name[0] | 0x20) == 'c' && strncasecmp(name, "connection", 10) == 0) return HTTP_HEADER_CONNECTION;
+            break;
+        case 12:
+            if ((name[0] | 0x20) == 'c' && strncasecmp(name, "content-type", 12) == 0) return HTTP_HEADER_CONTENT_TYPE;
+            break;
+        case 14:
+            if ((name[0] | 0x20) == 'c' && strncasecmp(name, "content-length", 14) == 0) return HTTP_HEADER_CONTENT_LENGTH;
+            break;
+        case 13:
+            if ((name[0] | 0x20) == 'i' && strncasecmp(name, "if-none-match", 13) == 0) return HTTP_HEADER_IF_NONE_MATCH;
+            break;
+        case 15:
+            if ((name[0] | 0x20) == 'a' && strncasecmp(name, "accept-encoding", 15) == 0) return HTTP_HEADER_ACCEPT_ENCODING;
+            break;
+        case 17:
+            if ((name[0] | 0x20) == 't' && strncasecmp(name, "transfer-encoding", 17) == 0) return HTTP_HEADER_TRANSFER_ENCODING;
+            break;
+    }
+    return HTTP_HEADER_OTHER;
+}
+
+void HttpHeaderTable::clear() {
+    count = 0;
+    memset(wellKnown, -1, sizeof(wellKnown));
+    contentLengthValue = 0;
+    contentLengthInvalid = false;
+    closeRequested = false;
+}
+
+bool HttpHeaderTable::add(const HttpSlice &name, const HttpSlice &value) {
+    if (count >= CAPACITY) {
+        return false;
+    }
+    HttpHeaderSlice &entry = entries[count];
+    entry.name = name;
+    entry.value = value;
+    entry.nameHash = hashName(name.data, name.length);
+
+    HttpHeaderId id = identify(name.data, name.length);
+    if (id == HTTP_HEADER_CONTENT_LENGTH && wellKnown[id] >= 0) {
+        // A repeated Content-Length must agree with the first, or the body framing is ambiguous
+        size_t repeated;
+        if (!value.toSize(repeated) || repeated != contentLengthValue) {
+            contentLengthInvalid = true;
+        }
+    }
+    if (id != HTTP_HEADER_OTHER && wellKnown[id] < 0) {
+        wellKnown[id] = static_cast<int8_t>(count);
+        if (id == HTTP_HEADER_CONTENT_LENGTH) {
+            contentLengthInvalid = !value.toSize(contentLengthValue);
+        } else if (id == HTTP_HEADER_CONNECTION) {
+            closeRequested = value.containsIgnoreCase("close");
+        }
+    }
+    count++;
+    return true;
+}
+
+bool HttpHeaderTable::contentLength(size_t &out) const {
+    if (wellKnown[HTTP_HEADER_CONTENT_LENGTH] < 0 || contentLengthInvalid) {
+        return false;
+    }
+    out = contentLengthValue;
+    return true;
+}
+
+const HttpHeaderSlice* HttpHeaderTable::find(const char *name, size_t nameLen) const {
+    HttpHeaderId id = identify(name, nameLen);
+    if (id != HTTP_HEADER_OTHER) {
+        return get(id);
+    }
+    uint32_t hash = hashName(name, nameLen);
+    for (size_t i = 0; i < count; i++) {
+        const HttpHeaderSlice &entry = entries[i];
+        if (entry.nameHash == hash && entry.name.length == nameLen && strncasecmp(entry.name.data, name, nameLen) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// HttpSlice Implementation
+// ============================================================================
+
+String HttpSlice::toString() const {
+    if (length == 0) {
+        return String();
+    }
+    return String(data, length);
+}
+
+bool HttpSlice::equals(const char *str) const {
+    return strlen(str) == length && memcmp(data, str, length) == 0;
+}
+
+bool HttpSlice::equals(const String &str) const {
+    return str.length() == length && memcmp(data, str.c_str(), length) == 0;
+}
+
+bool HttpSlice::equalsIgnoreCase(const char *str) const {
+    return strlen(str) == length && strncasecmp(data, str, length) == 0;
+}
+
+bool HttpSlice::equalsIgnoreCase(const HttpSlice &other) const {
+    return other.length == length && strncasecmp(data, other.data, length) == 0;
+}
+
+bool HttpSlice::toSize(size_t &out) const {
+    if (length == 0) return false;
+    size_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] < '0' || data[i] > '9') return false;
+        size_t digit = static_cast<size_t>(data[i] - '0');
+        if (value > (SIZE_MAX - digit) / 10) return false; // does not fit in size_t
+        value = value * 10 + digit;
+    }
+    out = value;
+    return true;
+}
+
+bool HttpSlice::containsIgnoreCase(const char *needle) const {
+    size_t needleLen = strlen(needle);
+    if (needleLen > length) return false;
+    for (size_t i = 0; i + needleLen <= length; i++) {
+        if (strncasecmp(data + i, needle, needleLen) == 0) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // ============================================================================
 // HttpResponse Implementation
 // ============================================================================
 
-HubHttpResponse::HubHttpResponse() : status(200) {}
+HubHttpResponse::HubHttpResponse() : status(200), bodyData(nullptr), bodyLength(-1), autoETag(false) {}
 
-HubHttpResponse::HubHttpResponse(int statusCode) : status(statusCode) {}
+HubHttpResponse::HubHttpResponse(int statusCode) : status(statusCode), bodyData(nullptr), bodyLength(-1), autoETag(false) {}
 
 HubHttpResponse::HubHttpResponse(int statusCode, const String &responseBody) 
-    : status(statusCode), body(responseBody) {}
+    : status(statusCode), body(responseBody), bodyData(nullptr), bodyLength(-1), autoETag(false) {}
 
 HubHttpResponse& HubHttpResponse::setStatus(int statusCode) {
     status = statusCode;
@@ -844,6 +1824,8 @@ HubHttpResponse& HubHttpResponse::setStatus(int statusCode) {
 
 HubHttpResponse& HubHttpResponse::setBody(const String &content) {
     body = content;
+    bodyGenerator = nullptr;
+    bodyData = nullptr;
     return *this;
 }
 
@@ -854,22 +1836,57 @@ HubHttpResponse& HubHttpResponse::setHeader(const String &name, const String &va
 
 HubHttpResponse& HubHttpResponse::json(const String &jsonBody) {
     body = jsonBody;
+    bodyGenerator = nullptr;
+    bodyData = nullptr;
     headers["Content-Type"] = "application/json";
     return *this;
 }
 
 HubHttpResponse& HubHttpResponse::html(const String &htmlBody) {
     body = htmlBody;
+    bodyGenerator = nullptr;
+    bodyData = nullptr;
     headers["Content-Type"] = "text/html; charset=utf-8";
     return *this;
 }
 
 HubHttpResponse& HubHttpResponse::text(const String &textBody) {
     body = textBody;
+    bodyGenerator = nullptr;
+    bodyData = nullptr;
     headers["Content-Type"] = "text/plain; charset=utf-8";
     return *this;
 }
 
+HubHttpResponse& HubHttpResponse::stream(const String &contentType, BodyGenerator generator, int32_t contentLength) {
+    body = "";
+    bodyGenerator = generator;
+    bodyData = nullptr;
+    bodyLength = contentLength;
+    headers["Content-Type"] = contentType;
+    return *this;
+}
+
+HubHttpResponse& HubHttpResponse::staticBody(const String &contentType, const uint8_t *data, size_t length) {
+    body = "";
+    bodyGenerator = nullptr;
+    bodyData = data;
+    bodyLength = static_cast<int32_t>(length);
+    headers["Content-Type"] = contentType;
+    return *this;
+}
+
+HubHttpResponse& HubHttpResponse::etag() {
+    autoETag = true;
+    return *this;
+}
+
+HubHttpResponse& HubHttpResponse::etag(const String &tag) {
+    autoETag = false;
+    headers["ETag"] = tag;
+    return *this;
+}
+
 HubHttpResponse& HubHttpResponse::cors(const String &origin) {
     headers["Access-Control-Allow-Origin"] = origin;
     headers["Access-Control-Allow-Methods"] = "GET, POST, PUT, DELETE, OPTIONS";
@@ -891,8 +1908,32 @@ HubHttpResponse HubHttpResponse::error(int statusCode, const String &message) {
 
 
 
-HttpClientConnection::HttpClientConnection(WiFiClient client) : client(client) {
+HttpClientConnection::HttpClientConnection(WiFiClient client) : client(client), rxLength(0), txPending(0) {
     lastActivityMillis = millis();
+    lastReceiveMillis = lastActivityMillis;
+    requestStartMillis = lastActivityMillis;
+    lastWriteMillis = lastActivityMillis;
+    closeAfterSend = false;
+    resetRequestState();
+}
+
+void HttpClientConnection::resetRequestState() {
+    headersComplete = false;
+    parsedLength = 0;
+    headerLength = 0;
+    numHeaders = 0;
+    readLimit = 0;
+    continueSent = false;
+    chunkedActive = false;
+    chunkedDone = false;
+    chunkedLength = 0;
+    route = -1;
+    staticRoute = -1;
+    pathMatch = -1;
+    numRouteParams = 0;
+    routeRemainingPath = HttpSlice();
+    routeChecked = false;
+    streamedLength = 0;
 }
 
 HttpClientConnection::~HttpClientConnection() {
@@ -917,6 +1958,263 @@ WiFiClient& HttpClientConnection::getClient() {
     return client;
 }
 
+int HttpClientConnection::receive(size_t maxSize) {
+    int avail = client.available();
+    if (avail <= 0) {
+        avail = 1; // let read() block/report as it normally would
+    }
+
+    // Grow the buffer (upto maxSize) to fit what is waiting
+    size_t wanted = rxLength + static_cast<size_t>(avail);
+    if (wanted > maxSize) {
+        wanted = maxSize;
+    }
+    if (wanted > rxBuffer.size()) {
+        size_t newSize = rxBuffer.empty() ? HttpServer::DEFAULT_BUFFER_SIZE : rxBuffer.size();
+        while (newSize < wanted) {
+            newSize *= 2;
+        }
+        if (newSize > maxSize) {
+            newSize = maxSize;
+        }
+        const char *oldBase = reinterpret_cast<const char*>(rxBuffer.data());
+        rxBuffer.resize(newSize);
+        rebaseParsedRequest(oldBase);
+    }
+    if (rxLength >= rxBuffer.size()) {
+        return 0;
+    }
+
+    int read_result = client.read(rxBuffer.data() + rxLength, rxBuffer.size() - rxLength);
+    if (read_result > 0) {
+        if (rxLength == 0) {
+            requestStartMillis = millis();
+        }
+        rxLength += read_result;
+        lastReceiveMillis = millis();
+    }
+    return read_result;
+}
+
+void HttpClientConnection::rebaseParsedRequest(const char *oldBase) {
+    const char *newBase = reinterpret_cast<const char*>(rxBuffer.data());
+    if (!headersComplete || oldBase == newBase) {
+        return;
+    }
+    // The parsed request line/header pointers refer to the old allocation - move them to the new one
+    method = newBase + (method - oldBase);
+    path = newBase + (path - oldBase);
+    for (size_t h = 0; h < numHeaders; h++) {
+        if (headers[h].name != nullptr) {
+            headers[h].name = newBase + (headers[h].name - oldBase);
+        }
+        headers[h].value = newBase + (headers[h].value - oldBase);
+    }
+    // Route params point into the path (their names belong to the route)
+    for (size_t p = 0; p < numRouteParams; p++) {
+        routeParams[p].value.data = newBase + (routeParams[p].value.data - oldBase);
+    }
+    if (routeRemainingPath.data != nullptr) {
+        routeRemainingPath.data = newBase + (routeRemainingPath.data - oldBase);
+    }
+}
+
+void HttpClientConnection::saveRouteMatch(const HttpRequest &req) {
+    numRouteParams = req.numParamViews;
+    for (size_t p = 0; p < numRouteParams; p++) {
+        routeParams[p] = req.paramViews[p];
+    }
+    routeRemainingPath = req.remainingPathView;
+}
+
+void HttpClientConnection::restoreRouteMatch(HttpRequest &req) const {
+    req.numParamViews = numRouteParams;
+    for (size_t p = 0; p < numRouteParams; p++) {
+        req.paramViews[p] = routeParams[p];
+    }
+    req.remainingPathView = routeRemainingPath;
+}
+
+void HttpClientConnection::truncate(size_t length) {
+    if (length < rxLength) {
+        rxLength = length;
+    }
+}
+
+void HttpClientConnection::erase(size_t offset, size_t count) {
+    if (offset >= rxLength) {
+        return;
+    }
+    if (count >= rxLength - offset) {
+        rxLength = offset;
+        return;
+    }
+    memmove(rxBuffer.data() + offset, rxBuffer.data() + offset + count, rxLength - offset - count);
+    rxLength -= count;
+}
+
+size_t HttpClientConnection::writeSome(const uint8_t *data, size_t length) {
+    // 0 is also what Print returns when the client does not implement availableForWrite() -
+    // offer at most one segment then and let the return value of write() say what fit
+    int room = client.availableForWrite();
+    size_t limit = room > 0 ? static_cast<size_t>(room) : HttpServer::SEND_BUFFER_SIZE;
+    if (length > limit) {
+        length = limit;
+    }
+    size_t written = client.write(data, length);
+    if (written > 0) {
+        lastWriteMillis = millis();
+        lastActivityMillis = lastWriteMillis;
+    }
+    return written;
+}
+
+void HttpClientConnection::send(const uint8_t *data, size_t length) {
+    size_t written = txQueue.empty() ? writeSome(data, length) : 0;
+    if (written >= length) {
+        return;
+    }
+    if (txQueue.empty()) {
+        lastWriteMillis = millis(); // stall time counts from when output started waiting
+    }
+    OutputSegment segment;
+    segment.bytes.assign(data + written, data + length);
+    segment.offset = 0;
+    txPending += length - written;
+    txQueue.push_back(std::move(segment));
+}
+
+void HttpClientConnection::send(String &&text, size_t offset) {
+    size_t length = text.length();
+    if (offset >= length) {
+        return;
+    }
+    if (txQueue.empty()) {
+        offset += writeSome(reinterpret_cast<const uint8_t*>(text.c_str()) + offset, length - offset);
+        if (offset >= length) {
+            return;
+        }
+        lastWriteMillis = millis();
+    }
+    OutputSegment segment;
+    segment.text = std::move(text);
+    segment.offset = offset;
+    txPending += length - offset;
+    txQueue.push_back(std::move(segment));
+}
+
+void HttpClientConnection::sendStatic(const uint8_t *data, size_t length) {
+    size_t written = txQueue.empty() ? writeSome(data, length) : 0;
+    if (written >= length) {
+        return;
+    }
+    if (txQueue.empty()) {
+        lastWriteMillis = millis();
+    }
+    OutputSegment segment;
+    segment.external = data + written;
+    segment.externalLength = length - written;
+    txPending += length - written;
+    txQueue.push_back(std::move(segment));
+}
+
+void HttpClientConnection::send(const BodyGenerator &generator, int32_t length) {
+    OutputSegment segment;
+    segment.offset = 0;
+    segment.generator = generator;
+    segment.remaining = length;
+    txQueue.push_back(std::move(segment));
+    flushOutput(); // start on the first chunk right away
+}
+
+bool HttpClientConnection::generateChunk(OutputSegment &segment) {
+    // Chunked framing is built around the data in place: hex length + CRLF before, CRLF after
+    static const size_t CHUNK_PREFIX = 10;
+    bool chunked = segment.remaining < 0;
+    size_t want = HttpServer::STREAM_CHUNK_SIZE;
+    if (!chunked && static_cast<size_t>(segment.remaining) < want) {
+        want = static_cast<size_t>(segment.remaining);
+    }
+    size_t prefix = chunked ? CHUNK_PREFIX : 0;
+    segment.bytes.resize(prefix + want + 2);
+    size_t produced = segment.generator(segment.bytes.data() + prefix, want);
+    if (produced > want) {
+        produced = want;
+    }
+    segment.offset = prefix;
+
+    if (chunked) {
+        if (produced == 0) {
+            static const char LAST_CHUNK[] = "0\r\n\r\n";
+            segment.bytes.assign(LAST_CHUNK, LAST_CHUNK + sizeof(LAST_CHUNK) - 1);
+            segment.offset = 0;
+            segment.generator = nullptr;
+        } else {
+            char header[CHUNK_PREFIX + 1];
+            int headerLength = snprintf(header, sizeof(header), "%x\r\n", static_cast<unsigned>(produced));
+            segment.offset = prefix - headerLength;
+            memcpy(segment.bytes.data() + segment.offset, header, headerLength);
+            segment.bytes[prefix + produced] = '\r';
+            segment.bytes[prefix + produced + 1] = '\n';
+            segment.bytes.resize(prefix + produced + 2);
+        }
+    } else {
+        if (produced == 0) {
+            // Fewer bytes than the Content-Length promised - the client can only tell from a close
+            closeAfterSend = true;
+            return false;
+        }
+        segment.bytes.resize(produced);
+        segment.remaining -= static_cast<int32_t>(produced);
+        if (segment.remaining == 0) {
+            segment.generator = nullptr;
+        }
+    }
+    txPending += segment.bytes.size() - segment.offset;
+    return true;
+}
+
+bool HttpClientConnection::flushOutput() {
+    while (!txQueue.empty()) {
+        OutputSegment &segment = txQueue.front();
+        if (segment.generator && segment.offset >= segment.bytes.size()) {
+            if (!generateChunk(segment)) {
+                txQueue.pop_front();
+                continue;
+            }
+        }
+        size_t written = writeSome(segment.data() + segment.offset, segment.size() - segment.offset);
+        if (written == 0) {
+            return false; // socket is full - try again next tick
+        }
+        segment.offset += written;
+        txPending -= written;
+        if (segment.offset >= segment.size() && !segment.generator) {
+            txQueue.pop_front();
+        }
+    }
+    return true;
+}
+
+bool HttpClientConnection::outputStalled(uint32_t timeoutMs) const {
+    return !txQueue.empty() && millis() - lastWriteMillis > timeoutMs;
+}
+
+void HttpClientConnection::consume(size_t count) {
+    resetRequestState();
+    requestStartMillis = millis(); // any pipelined bytes left over start the next request now
+    if (count >= rxLength) {
+        rxLength = 0;
+        // Give back anything beyond the default size once a large request has been handled
+        if (rxBuffer.size() > HttpServer::DEFAULT_BUFFER_SIZE) {
+            std::vector<byte>(HttpServer::DEFAULT_BUFFER_SIZE).swap(rxBuffer);
+        }
+        return;
+    }
+    memmove(rxBuffer.data(), rxBuffer.data() + count, rxLength - count);
+    rxLength -= count;
+}
+
 
 
 // ============================================================================
@@ -12,11 +12,15 @@
 
 #include <vector>
 #include <map>
+#include <deque>
 #include <memory>
 #include <functional>
 #include <string>
 #include <stdexcept>
 #include <definitions.h>
+#include "picohttpparser/picohttpparser.h"
+#include "http_router.h"
+#include "http_static_files.h"
 
 // Forward declarations
 class HttpRequest;
@@ -28,21 +32,260 @@ typedef std::function<HubHttpResponse(HttpRequest &)> RouteHandler;
 typedef std::function<void(HttpRequest &, HubHttpResponse &)> MiddlewareHandler; // legacy (always continue)
 typedef std::function<bool(HttpRequest &, HubHttpResponse &)> MiddlewareHandlerBool; // return false to short-circuit
 typedef std::function<HubHttpResponse(int, const String &)> ErrorHandler;
+typedef std::function<bool(HttpRequest &, const uint8_t *, size_t)> BodyHandler; // return false to abort the upload
+typedef std::function<void(HttpRequest &, HubHttpResponse &)> RouteFillHandler; // fills the server's response in place
+typedef std::function<size_t(uint8_t *, size_t)> BodyGenerator; // fills up to size bytes, returns 0 once the body is complete
+
+// Plain function forms (no std::function wrapper, no captures) - context is passed through untouched
+typedef void (*RouteHandlerFn)(HttpRequest &req, HubHttpResponse &response, void *context);
+typedef bool (*MiddlewareHandlerFn)(HttpRequest &req, HubHttpResponse &response, void *context); // return false to short-circuit
+typedef void (*ErrorHandlerFn)(int statusCode, const String &message, HubHttpResponse &response, void *context);
+
+/**
+ * @brief Non-owning view of a byte range (usually inside a connection's receive buffer)
+ *
+ * A slice is only valid while the request that produced it is being handled.
+ * Use toString() to take an owned copy.
+ */
+struct HttpSlice {
+    const char *data;
+    size_t length;
+
+    HttpSlice() : data(nullptr), length(0) {}
+    HttpSlice(const char *d, size_t len) : data(d), length(len) {}
+
+    bool empty() const { return length == 0; }
+    String toString() const;
+    bool equals(const char *str) const;
+    bool equals(const String &str) const;
+    bool equalsIgnoreCase(const char *str) const;
+    bool equalsIgnoreCase(const HttpSlice &other) const;
+    bool containsIgnoreCase(const char *needle) const;
+    bool toSize(size_t &out) const; // parse an unsigned decimal, false if not a number or too large
+};
+
+/**
+ * @brief Headers the server and request helpers look up on every request
+ *
+ * These are recognised once while parsing and kept in dedicated slots.
+ */
+enum HttpHeaderId {
+    HTTP_HEADER_OTHER = -1,
+    HTTP_HEADER_ACCEPT = 0,
+    HTTP_HEADER_CONTENT_TYPE,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_HOST,
+    HTTP_HEADER_EXPECT,
+    HTTP_HEADER_TRANSFER_ENCODING,
+    HTTP_HEADER_ACCEPT_ENCODING,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADER_WELL_KNOWN_COUNT
+};
+
+struct HttpHeaderSlice {
+    HttpSlice name;
+    HttpSlice value;
+    uint32_t nameHash; // case-insensitive hash of name
+};
+
+/**
+ * @brief Fixed-capacity header table filled once per request
+ *
+ * Header names are hashed case-insensitively as they are added, so a lookup compares
+ * hashes before touching any bytes and never allocates.
+ */
+class HttpHeaderTable {
+public:
+    static const size_t CAPACITY = 16;
+
+    HttpHeaderTable() { clear(); }
+
+    /**
+     * @brief Add a header
+     * @return false if the table is full
+     */
+    bool add(const HttpSlice &name, const HttpSlice &value);
+
+    /**
+     * @brief Get a well-known header from its dedicated slot
+     * @return The (first) header with that id or nullptr if not present
+     */
+    const HttpHeaderSlice* get(HttpHeaderId id) const {
+        return wellKnown[id] >= 0 ? &entries[wellKnown[id]] : nullptr;
+    }
+
+    /**
+     * @brief Content-Length parsed at add() time
+     * @param out Receives the length when present and valid
+     * @return false if the header is missing, not a valid number, or repeated with a different value
+     */
+    bool contentLength(size_t &out) const;
+
+    bool hasInvalidContentLength() const { return contentLengthInvalid; }
+    bool connectionClose() const { return closeRequested; }
+
+    /**
+     * @brief Find a header by name (case-insensitive)
+     * @return The header or nullptr if not present
+     */
+    const HttpHeaderSlice* find(const char *name, size_t nameLen) const;
+    const HttpHeaderSlice* find(const char *name) const { return find(name, strlen(name)); }
+
+    size_t size() const { return count; }
+    const HttpHeaderSlice& operator[](size_t index) const { return entries[index]; }
+    void clear();
+
+    static uint32_t hashName(const char *name, size_t len);
+    static HttpHeaderId identify(const char *name, size_t len);
+
+private:
+    HttpHeaderSlice entries[CAPACITY];
+    size_t count;
+    int8_t wellKnown[HTTP_HEADER_WELL_KNOWN_COUNT]; // entry index per HttpHeaderId, -1 if absent
+    size_t contentLengthValue;
+    bool contentLengthInvalid;
+    bool closeRequested; // "Connection: close"
+};
+
+struct HttpQueryParamSlice {
+    HttpSlice name;  // raw (still percent-encoded)
+    HttpSlice value; // raw (still percent-encoded)
+    bool encoded;    // name or value contains '%' or '+' and needs decoding
+};
+
+struct HttpParamSlice {
+    HttpSlice name;  // points into the registered route pattern
+    HttpSlice value; // points into the request path
+};
 
 /**
  * @brief Represents an HTTP request with method, path, headers, query params and body
+ *
+ * The *View members always reference the raw request bytes and are what the accessor
+ * methods read from. The owned String/map members are only filled in when the server
+ * is not running in zero-copy mode (or when materialize() is called explicitly).
  */
 class HttpRequest {
 public:
+    static const size_t MAX_HEADERS = HttpHeaderTable::CAPACITY;
+    static const size_t MAX_PARAMS = 8;
+    static const size_t MAX_QUERY_PARAMS = 16;
+
     String method;
     String path;
     String body;
     std::map<String, String> headers;
     std::map<String, String> query;
     std::map<String, String> params; // path parameters
-    std::map<String, String> headersLower; // lowercase header lookup
+
+    HttpMethod methodId; // interned method (HTTP_METHOD_OTHER for custom verbs - see methodView)
+
+    // Zero-copy views into the receive buffer
+    HttpSlice methodView;
+    HttpSlice pathView;  // without query string or trailing slash
+    HttpSlice queryView; // raw query string (without the '?')
+    HttpSlice remainingPathView; // path below a wildcard route / mount point (no leading slash)
+    HttpSlice bodyView;
+    HttpHeaderTable headerViews;
+    HttpParamSlice paramViews[MAX_PARAMS];
+    size_t numParamViews;
     
     HttpRequest();
+
+    /**
+     * @brief Copy all views into the owned String/map members
+     *
+     * Called by the server unless zero-copy requests are enabled. Handlers running in
+     * zero-copy mode can call it when they need the legacy members populated.
+     */
+    void materialize();
+
+    /**
+     * @brief Get a header value without copying (case-insensitive)
+     * @param name Header name
+     * @return Slice of the header value (empty if not present)
+     */
+    HttpSlice getHeaderView(const char *name) const;
+    HttpSlice getHeaderView(HttpHeaderId id) const;
+
+    /**
+     * @brief Get a raw (undecoded) query parameter value without copying
+     * @param name Query parameter name (decoded form)
+     * @return Slice of the value (empty if not present)
+     */
+    HttpSlice getQueryParamView(const char *name) const;
+
+    /**
+     * @brief Decode a query parameter value into a caller-owned buffer
+     * @param name Query parameter name
+     * @param out Destination buffer (always NUL terminated when outSize > 0)
+     * @param outSize Size of the destination buffer
+     * @return Decoded length (may exceed outSize - 1 if truncated), or -1 if not present
+     */
+    int copyQueryParam(const char *name, char *out, size_t outSize) const;
+
+    /**
+     * @brief Get a query parameter as an integer (no allocation)
+     * @param name Query parameter name
+     * @param defaultValue Returned when missing or not a number
+     * @return Parsed value or default
+     */
+    long getQueryParamInt(const char *name, long defaultValue = 0) const;
+
+    /**
+     * @brief Get a query parameter as a float (no allocation)
+     * @param name Query parameter name
+     * @param defaultValue Returned when missing or not a number
+     * @return Parsed value or default
+     */
+    float getQueryParamFloat(const char *name, float defaultValue = 0.0f) const;
+
+    /**
+     * @brief Get a query parameter as a bool (no allocation)
+     *
+     * true/1/yes/on and a bare flag (?verbose) are true, false/0/no/off are false.
+     * @param name Query parameter name
+     * @param defaultValue Returned when missing or not recognised
+     * @return Parsed value or default
+     */
+    bool getQueryParamBool(const char *name, bool defaultValue = false) const;
+
+    /**
+     * @brief Get a path parameter value without copying
+     * @param name Parameter name (without the leading ':')
+     * @return Slice of the value (empty if not present)
+     */
+    HttpSlice getParamView(const char *name) const;
+
+    /**
+     * @brief Get the part of the path matched by a wildcard route or mount point
+     *
+     * For a route ending in a "*" segment under /static and a request for /static/css/site.css
+     * this is "css/site.css". Empty for other routes.
+     * @return The remaining path (without a leading slash)
+     */
+    String getRemainingPath() const;
+
+    /**
+     * @brief Get the raw request body (binary-safe, may contain NUL bytes)
+     * @return Pointer to the body bytes (nullptr when there is no body)
+     */
+    const uint8_t* bodyData() const;
+
+    /**
+     * @brief Get the request body length (the request's Content-Length)
+     * @return Body length in bytes
+     */
+    size_t bodyLength() const;
+
+    /**
+     * @brief Get a path parameter value
+     * @param name Parameter name (without the leading ':')
+     * @param defaultValue Default value if parameter not found
+     * @return Parameter value or default
+     */
+    String getParam(const String &name, const String &defaultValue = "") const;
     
     /**
      * @brief Check if the client requested JSON response (via Accept header or ?json=true query param)
@@ -59,7 +302,7 @@ public:
     String getHeader(const String &name, const String &defaultValue = "") const;
     
     /**
-     * @brief Get a query parameter value
+     * @brief Get a query parameter value (percent-decoded, '+' as space)
      * @param name Query parameter name
      * @param defaultValue Default value if parameter not found
      * @return Query parameter value or default
@@ -92,6 +335,19 @@ public:
      * @return true if matches
      */
     bool isContentType(const String &contentType) const;
+
+private:
+    // Query parameters are only split out of queryView on first use. Pairs beyond
+    // MAX_QUERY_PARAMS stay in the string from queryRest on and are scanned when looked up.
+    mutable HttpQueryParamSlice queryParams[MAX_QUERY_PARAMS];
+    mutable size_t numQueryParams;
+    mutable bool queryParsed;
+    mutable const char *queryRest;
+    mutable HttpQueryParamSlice overflowParam; // last match found past the table
+
+    static bool nextQueryParam(const char *&p, const char *end, HttpQueryParamSlice &qp);
+    void parseQuery() const;
+    const HttpQueryParamSlice* findQueryParam(const char *name) const;
 };
 
 /**
@@ -102,6 +358,10 @@ public:
     int status;
     String body;
     std::map<String, String> headers;
+    BodyGenerator bodyGenerator; // produces the body instead of `body` when set
+    const uint8_t *bodyData;     // or: a body kept elsewhere (e.g. in flash), sent without a copy
+    int32_t bodyLength;          // length of a generated or bodyData body, -1 if unknown (sent chunked)
+    bool autoETag;               // hash the body into an ETag header when sent
     
     HubHttpResponse();
     explicit HubHttpResponse(int statusCode);
@@ -149,6 +409,49 @@ public:
      * @return Reference to this response (for chaining)
      */
     HubHttpResponse& text(const String &textBody);
+
+    /**
+     * @brief Stream the body from a generator instead of building it in memory
+     *
+     * The generator is called from tick() after the handler has returned, each time the
+     * connection can take more, with a buffer of up to STREAM_CHUNK_SIZE bytes. It returns
+     * how many bytes it wrote and 0 once the body is complete, so capture any state it
+     * needs by value. With an unknown length the body is sent with
+     * Transfer-Encoding: chunked, otherwise with Content-Length (and the generator must
+     * produce exactly that many bytes).
+     * @param contentType Content-Type header value
+     * @param generator Function filling the next piece of the body
+     * @param contentLength Body length if known, -1 otherwise
+     * @return Reference to this response (for chaining)
+     */
+    HubHttpResponse& stream(const String &contentType, BodyGenerator generator, int32_t contentLength = -1);
+
+    /**
+     * @brief Send a body that lives elsewhere (flash, a static buffer) without copying it
+     * @param contentType Content-Type header value
+     * @param data Body bytes - must stay valid until the response has been sent
+     * @param length Body length
+     * @return Reference to this response (for chaining)
+     */
+    HubHttpResponse& staticBody(const String &contentType, const uint8_t *data, size_t length);
+
+    /**
+     * @brief Give this response a strong ETag computed from its body
+     *
+     * The body is hashed when the response is sent. A GET whose If-None-Match matches
+     * gets a header-only 304 Not Modified instead of the body.
+     * @return Reference to this response (for chaining)
+     */
+    HubHttpResponse& etag();
+
+    /**
+     * @brief Set the ETag explicitly (e.g. a version number the handler already knows)
+     * @param tag Entity tag including its quotes, e.g. "\"v42\""
+     * @return Reference to this response (for chaining)
+     */
+    HubHttpResponse& etag(const String &tag);
+
+    bool isStreaming() const { return static_cast<bool>(bodyGenerator); }
     
     /**
      * @brief Enable CORS for this response
@@ -184,17 +487,208 @@ public:
     bool connected();
     WiFiClient& getClient();
 
+    /**
+     * @brief Read what the client has available into the receive buffer
+     * @param maxSize Maximum number of bytes the buffer may hold
+     * @return Bytes read, 0 if the buffer is full or nothing was read, -1 on error
+     */
+    int receive(size_t maxSize);
+
+    /**
+     * @brief Drop a handled request from the front of the receive buffer
+     * @param count Number of bytes to drop
+     */
+    void consume(size_t count);
+
+    byte* buffer() { return rxBuffer.data(); }
+    size_t bufferedLength() const { return rxLength; }
+
+    /**
+     * @brief Shorten the buffered data (used after decoding a chunked body in place)
+     * @param length New buffered length
+     */
+    void truncate(size_t length);
+
+    /**
+     * @brief Remember the path params / wildcard remainder a request's route match filled in
+     */
+    void saveRouteMatch(const HttpRequest &req);
+
+    /**
+     * @brief Hand the saved route match to a request view built on a later tick
+     */
+    void restoreRouteMatch(HttpRequest &req) const;
+
+    /**
+     * @brief Send bytes to the client without blocking
+     *
+     * Writes as much as the socket has room for now and queues the rest (copied) for
+     * flushOutput(). Queued output is always sent in order.
+     */
+    void send(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Send a String from an offset, taking ownership of the unsent part
+     */
+    void send(String &&text, size_t offset = 0);
+
+    /**
+     * @brief Queue a generated body, pulled one chunk at a time as the socket drains
+     * @param generator Function filling the next piece of the body
+     * @param length Body length, or -1 to frame it with chunked transfer encoding
+     */
+    void send(const BodyGenerator &generator, int32_t length);
+
+    /**
+     * @brief Send bytes that stay valid until they are sent (flash, static data) without copying them
+     */
+    void sendStatic(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Write queued output while the socket has room for it
+     * @return true once nothing is left queued
+     */
+    bool flushOutput();
+
+    bool hasPendingOutput() const { return !txQueue.empty(); }
+    size_t pendingOutputLength() const { return txPending; }
+
+    /**
+     * @brief Check whether queued output has made no progress for a while
+     * @param timeoutMs Time without a successful write
+     */
+    bool outputStalled(uint32_t timeoutMs) const;
+
+    /**
+     * @brief Remove a range from the middle of the buffered data
+     * @param offset Start of the range
+     * @param count Number of bytes to remove
+     */
+    void erase(size_t offset, size_t count);
+
+    // Incremental parse state for the request at the front of the buffer
+    bool headersComplete;
+    size_t parsedLength;    // bytes already scanned for the end of the headers
+    size_t headerLength;    // request line + headers, once complete
+    const char *method;
+    size_t methodLength;
+    const char *path;
+    size_t pathLength;
+    struct phr_header headers[HttpRequest::MAX_HEADERS];
+    size_t numHeaders;
+    size_t readLimit;       // how much the buffer may hold while this request is read (0 = server default)
+    u32_t requestStartMillis;
+    u32_t lastReceiveMillis;
+    bool continueSent;      // "100 Continue" already sent
+    bool chunkedActive;     // body uses Transfer-Encoding: chunked
+    bool chunkedDone;       // terminating chunk seen
+    size_t chunkedLength;   // decoded body bytes (directly after the headers)
+    struct phr_chunked_decoder chunkedDecoder;
+    // Route match, resolved once when the headers are complete and reused on every later tick
+    int route;              // dynamic route the request resolved to, -1 if none
+    int staticRoute;        // or: index into the compile-time route table, -1 if none
+    int pathMatch;          // path routed for other methods only (for a 405), -1 if not
+    HttpParamSlice routeParams[HttpRequest::MAX_PARAMS]; // path params of the match (values point into the buffer)
+    size_t numRouteParams;
+    HttpSlice routeRemainingPath;                        // wildcard remainder of the match
+    bool routeChecked;
+    size_t streamedLength;  // body bytes already handed to a streaming route
+    bool closeAfterSend;    // close once the queued output has been sent
+
 private:
+    struct OutputSegment {
+        std::vector<uint8_t> bytes; // either a copied byte range (or the current generated chunk) ...
+        String text;                // ... or a response body moved into the queue
+        size_t offset;              // bytes of this segment already written
+        BodyGenerator generator;    // set while a generated body has more to produce
+        int32_t remaining;          // generated bytes still to come, -1 for a chunked body
+
+        const uint8_t *external;    // or: bytes owned by someone else (flash), not copied
+        size_t externalLength;
+
+        OutputSegment() : offset(0), remaining(0), external(nullptr), externalLength(0) {}
+
+        const uint8_t* data() const {
+            if (external != nullptr) return external;
+            return bytes.empty() ? reinterpret_cast<const uint8_t*>(text.c_str()) : bytes.data();
+        }
+        size_t size() const {
+            if (external != nullptr) return externalLength;
+            return bytes.empty() ? text.length() : bytes.size();
+        }
+    };
+
+    void resetRequestState();
+    void rebaseParsedRequest(const char *oldBase);
+    size_t writeSome(const uint8_t *data, size_t length);
+    bool generateChunk(OutputSegment &segment);
+
     WiFiClient client;
     u32_t lastActivityMillis;
+    std::vector<byte> rxBuffer; // persists across ticks so pipelined requests are not lost
+    size_t rxLength;
+    std::deque<OutputSegment> txQueue; // response bytes the socket had no room for yet
+    size_t txPending;
+    u32_t lastWriteMillis;
+};
+
+/**
+ * @brief Per-route request limits, checked as soon as the request's headers are parsed
+ *
+ * Zero means "use the server-wide setting". Requests with more than MAX_HEADERS (16)
+ * headers get 431 on every route, so maxHeaders only has an effect below that.
+ */
+struct RouteLimits {
+    size_t maxBodySize = 0;     // larger bodies get 413 before they are read
+    uint8_t maxHeaders = 0;     // more headers get 431
+    uint32_t readDeadline = 0;  // ms from the first byte until the body is complete, else 408
+};
+
+/**
+ * @brief Per-route response caching (see HttpServer::setResponseCache())
+ *
+ * Requests for the same path that agree on the listed query parameters and headers share
+ * one cached response.
+ */
+struct ResponseCachePolicy {
+    uint32_t ttl = 0;                // ms a cached response stays fresh, 0 = not cached
+    std::vector<String> varyQuery;   // query parameters that select a different entry
+    std::vector<String> varyHeaders; // request headers that select a different entry
+};
+
+/**
+ * @brief A middleware - either a std::function or a plain function with a context pointer
+ */
+struct HttpMiddleware {
+    MiddlewareHandlerBool handler;
+    MiddlewareHandlerFn fn;
+    void *context;
+
+    HttpMiddleware(const MiddlewareHandlerBool &h) : handler(h), fn(nullptr), context(nullptr) {}
+    HttpMiddleware(MiddlewareHandlerFn f, void *ctx) : fn(f), context(ctx) {}
+
+    bool operator()(HttpRequest &req, HubHttpResponse &response) const {
+        return fn != nullptr ? fn(req, response, context) : handler(req, response);
+    }
 };
 
 struct RoutePattern {
-    String method;
+    String method;  // empty for any method
     String pattern; // e.g. /api/item/:id
-    std::vector<String> segments;
-    RouteHandler handler;
-    bool hasParams = false;
+    RouteHandler handler;         // returns the response
+    RouteFillHandler fillHandler; // or fills it in place
+    RouteHandlerFn handlerFn = nullptr; // or a plain function
+    void *handlerContext = nullptr;
+    BodyHandler bodyHandler; // set for streaming upload routes
+    std::vector<HttpMiddleware> routeMiddlewares; // attached to this route only
+    std::vector<HttpMiddleware> middlewares;      // resolved chain: prefix-scoped, then routeMiddlewares
+    RouteLimits limits;
+    ResponseCachePolicy cache;
+};
+
+struct ScopedMiddleware {
+    String prefix;
+    HttpMiddleware handler;
 };
 
 /**
@@ -216,9 +710,10 @@ public:
     static const size_t MAX_BUFFER_SIZE = 8192;
     static const size_t MIN_FREE_RAM = 4096;
     static const uint16_t CLIENT_TIMEOUT_MS = 5000;
-    static const uint16_t WRITE_TIMEOUT_MS = 1000;
-    static const size_t WRITE_CHUNK_SIZE = 512;
-    static const size_t MAX_HEADERS = 16;
+    static const uint16_t WRITE_TIMEOUT_MS = 1000;   // queued output may stall this long before the client is dropped
+    static const size_t SEND_BUFFER_SIZE = 1436; // one TCP segment (lwIP TCP_MSS)
+    static const size_t STREAM_CHUNK_SIZE = 1024; // most a body generator is asked for at once
+    static const size_t MAX_HEADERS = HttpRequest::MAX_HEADERS;
     static const size_t DEFAULT_MAX_CONNECTIONS = 4;
 
     struct HttpServerConfig {
@@ -228,6 +723,7 @@ public:
         uint32_t connectionInactivityTimeout = 300000; // 5 min
         size_t maxConnections = DEFAULT_MAX_CONNECTIONS;
         bool keepAlive = false;
+        bool zeroCopyRequests = false; // skip copying requests into String/map members
         bool debug = false;
     };
     
@@ -251,11 +747,163 @@ public:
     
     /**
      * @brief Register a route handler
-     * @param path URL path (e.g., "/api/status")
+     *
+     * Routes are compiled into a segment tree as they are registered, so lookup cost
+     * depends on the path length rather than the number of routes. Registering the same
+     * method and path again replaces the handler.
+     * @param path URL path (e.g., "/api/status"), may contain :params
      * @param handler Function to handle requests to this path
      */
     void on(const String &path, RouteHandler handler);
     void on(const String &method, const String &path, RouteHandler handler); // method-specific + params
+    void on(HttpMethod method, const String &path, RouteHandler handler);
+
+    /**
+     * @brief Register a route handler that fills in the server's response
+     *
+     * The handler writes into the response the server sends, instead of returning one
+     * to be assigned over it. Anything middleware has already set on it is kept.
+     * @param path URL path, may contain :params
+     * @param handler Function to fill in the response
+     */
+    void on(const String &path, RouteFillHandler handler);
+    void on(const String &method, const String &path, RouteFillHandler handler);
+
+    /**
+     * @brief Register a plain function as a route handler
+     *
+     * No std::function is created and nothing is allocated per call - state is reached
+     * through context (e.g. a pointer to the object owning the route).
+     * @param method HTTP method (e.g., "GET"), empty for any method
+     * @param path URL path, may contain :params
+     * @param handler Function to fill in the response
+     * @param context Passed to handler on every call
+     */
+    void on(const String &method, const String &path, RouteHandlerFn handler, void *context);
+
+    /**
+     * @brief Register a route with middleware that only runs for this route
+     *
+     * The middleware runs after the global and prefix-scoped middleware, in the order given.
+     * @param method HTTP method (e.g., "POST")
+     * @param path URL path, may contain :params
+     * @param handler Function to handle requests to this path
+     * @param middleware Route middleware, return false to short-circuit
+     */
+    void on(const String &method, const String &path, RouteHandler handler,
+            const std::vector<MiddlewareHandlerBool> &middleware);
+
+    /**
+     * @brief Hand everything at and below a path prefix to one handler
+     *
+     * Same as on() with a trailing "*" segment added to prefix. The handler reads the part of the path below
+     * the prefix with req.getRemainingPath(), e.g. to dispatch to a sub-router.
+     * More specific routes registered under the prefix still take precedence.
+     * @param prefix Path prefix (e.g., "/api/v1"), may contain :params
+     * @param handler Function to handle requests below the prefix (any method)
+     */
+    void mount(const String &prefix, RouteHandler handler);
+
+#if HUB_HTTP_HAS_FS
+    /**
+     * @brief Serve the files below a directory of a filesystem (LittleFS, SPIFFS, SD, ...)
+     *
+     * GET and HEAD requests below prefix map to files below root. Files are streamed in
+     * STREAM_CHUNK_SIZE pieces as the client reads them, never loaded whole. A directory
+     * (or the prefix itself) serves its index.html. Content-Type comes from the file
+     * extension.
+     * @param prefix URL prefix (e.g., "/ui")
+     * @param fs Filesystem, already mounted
+     * @param root Directory in fs (e.g., "/www")
+     * @param cacheControl Cache-Control header value for served files, empty for none
+     */
+    void serveStatic(const String &prefix, fs::FS &fs, const String &root = "/", const String &cacheControl = "");
+#endif
+
+    /**
+     * @brief Serve files linked into the firmware (see HttpEmbeddedFile)
+     *
+     * The files are sent straight from flash. The table must stay valid while the server runs.
+     * @param prefix URL prefix (e.g., "/ui")
+     * @param files File table
+     * @param count Number of entries in files
+     * @param cacheControl Cache-Control header value for served files, empty for none
+     */
+    void serveStatic(const String &prefix, const HttpEmbeddedFile *files, size_t count, const String &cacheControl = "");
+
+    /**
+     * @brief Serve a compile-time route table (see http_static_router.h)
+     *
+     * The table is tried before routes registered with on(), after global middleware.
+     * It needs no registration at startup and no heap.
+     * @tparam Router A StaticRouter<...> type
+     */
+    template <typename Router>
+    void useStaticRoutes() {
+        staticFind = &Router::find;
+        staticInvoke = &Router::invoke;
+    }
+
+    /**
+     * @brief Set request limits for one registered route
+     *
+     * Lets cheap control endpoints reject oversized or slow requests early while upload
+     * routes keep a larger allowance. The limits are checked right after the headers are
+     * parsed, before any of the body is waited for.
+     * @param method HTTP method the route was registered with (empty for any method)
+     * @param path Path pattern exactly as registered
+     * @param limits Limits for the route (zero fields use the server-wide setting)
+     * @return false if no such route is registered
+     */
+    bool setRouteLimits(const String &method, const String &path, const RouteLimits &limits);
+
+    /**
+     * @brief Cache the responses of one registered GET route
+     *
+     * A hit is sent as one stored buffer - the serialized status line, headers and body -
+     * without calling the handler. Middleware still runs first on every request (and can
+     * reject it), but headers it adds are those stored with the entry. Only 200 responses
+     * with a String or static body are stored; requests carrying If-None-Match bypass the
+     * cache. Registering the route again, or changing its policy, drops its entries.
+     * @param method HTTP method the route was registered with (empty for any method)
+     * @param path Path pattern exactly as registered
+     * @param policy TTL and the query parameters / headers that key the entries
+     * @return false if no such route is registered
+     */
+    bool setResponseCache(const String &method, const String &path, const ResponseCachePolicy &policy);
+
+    /**
+     * @brief Set how many bytes the response cache may hold (default 16 KB)
+     *
+     * The least recently used entries are evicted to stay within the budget.
+     */
+    void setResponseCacheBudget(size_t bytes);
+
+    /**
+     * @brief Drop every cached response
+     */
+    void invalidateResponseCache();
+
+    /**
+     * @brief Drop the cached responses of one route (e.g. after the data behind it changed)
+     * @return false if no such route is registered
+     */
+    bool invalidateResponseCache(const String &method, const String &path);
+
+    /**
+     * @brief Register a streaming upload route
+     *
+     * The request body is handed to onBody piece by piece as it arrives and is never
+     * buffered in full, so uploads are not limited by maxRequestSize. onComplete builds
+     * the response once the whole body has been received. While streaming, read request
+     * data through the accessor methods (getHeader, getParam, ...) - the String/map
+     * members are only populated for onComplete.
+     * @param method HTTP method (e.g., "POST")
+     * @param path URL path, may contain :params
+     * @param onBody Called for each piece of the body, return false to abort the upload
+     * @param onComplete Called after the last piece to produce the response
+     */
+    void onUpload(const String &method, const String &path, BodyHandler onBody, RouteHandler onComplete);
     
     /**
      * @brief Register a middleware handler (executes for all requests)
@@ -263,12 +911,32 @@ public:
      */
     void use(MiddlewareHandler middleware);
     void use(MiddlewareHandlerBool middleware); // short-circuit capable
+
+    /**
+     * @brief Register middleware for the routes at or below a path prefix
+     *
+     * The chain for each route is worked out when routes or middleware are registered,
+     * so requests to other routes (and the built-in / and /log pages) never run it.
+     * Scoped middleware runs after the global middleware, in registration order.
+     * @param prefix Route path prefix (e.g., "/api/admin"), compared by whole segments
+     * @param middleware Function to process request/response, return false to short-circuit
+     */
+    void use(const String &prefix, MiddlewareHandlerBool middleware);
+
+    /**
+     * @brief Register a plain function as middleware (global or for a route prefix)
+     * @param middleware Function to process request/response, return false to short-circuit
+     * @param context Passed to middleware on every call
+     */
+    void use(MiddlewareHandlerFn middleware, void *context);
+    void use(const String &prefix, MiddlewareHandlerFn middleware, void *context);
     
     /**
      * @brief Set custom error handler
      * @param handler Function to generate error responses
      */
     void onError(ErrorHandler handler);
+    void onError(ErrorHandlerFn handler, void *context); // plain function, fills the error response in place
     
     /**
      * @brief Set custom 404 Not Found handler
@@ -335,6 +1003,27 @@ public:
     void setConnectionInactivityTimeout(uint32_t timeoutMs);
     void setMaxConnections(size_t maxConn);
     void setKeepAlive(bool enabled);
+
+    /**
+     * @brief Enable zero-copy requests
+     *
+     * When enabled, HttpRequest only carries slices into the receive buffer and the
+     * legacy String/map members stay empty. Use the accessor methods (or *View members)
+     * from handlers, or call req.materialize() for an owned copy.
+     * @param enabled true to enable zero-copy requests
+     */
+    void setZeroCopyRequests(bool enabled);
+
+    /**
+     * @brief Enable the cache of recently resolved routes (enabled by default)
+     *
+     * Keeps the last few (method, path) -> route lookups, including extracted params, so
+     * endpoints that are polled repeatedly skip the route tree. Registering a route
+     * empties the cache. Each cacheable request counts as exactly one hit or miss
+     * (see getRouteCacheHits / getRouteCacheMisses).
+     * @param enabled true to enable the route cache
+     */
+    void setRouteCacheEnabled(bool enabled);
     
     /**
      * @brief Get server running state
@@ -349,6 +1038,12 @@ public:
     uint16_t getPort() const { return port; }
     bool getKeepAlive() const { return keepAlive; }
     size_t getMaxConnections() const { return maxConnections; }
+    bool getZeroCopyRequests() const { return zeroCopyRequests; }
+    uint32_t getRouteCacheHits() const { return router.cacheHits(); }
+    uint32_t getRouteCacheMisses() const { return router.cacheMisses(); }
+    uint32_t getResponseCacheHits() const { return responseCacheHits; }
+    uint32_t getResponseCacheMisses() const { return responseCacheMisses; }
+    size_t getResponseCacheSize() const { return responseCacheBytes; }
 
     void addDefaultHeader(const String &name, const String &value);
     void removeDefaultHeader(const String &name);
@@ -367,6 +1062,7 @@ private:
     uint32_t connectionInactivityTimeout = 300000;
     size_t maxConnections = DEFAULT_MAX_CONNECTIONS;
     bool keepAlive = false;
+    bool zeroCopyRequests = false;
     String serverName = "Hub-Server";
     String serverVersion = "1.0";
     String corsOrigin = "*";
@@ -375,29 +1071,64 @@ private:
     
     // Server components
     WiFiServer server;
-    std::map<String, RouteHandler> httpHandlers; // legacy any-method exact path
-    std::vector<RoutePattern> patternHandlers;
-    std::vector<MiddlewareHandlerBool> middlewares; // unified middleware list
+    HttpRouter router;
+    std::vector<RoutePattern> routes; // indexed by the route ids stored in router
+    std::vector<HttpMiddleware> middlewares; // unified middleware list
+    std::vector<ScopedMiddleware> scopedMiddlewares;
+    int (*staticFind)(HttpRequest &req) = nullptr;
+    void (*staticInvoke)(int index, HttpRequest &req, HubHttpResponse &response) = nullptr;
     RouteHandler notFoundHandler;
     ErrorHandler errorHandler;
+    ErrorHandlerFn errorHandlerFn = nullptr;
+    void *errorHandlerContext = nullptr;
     std::vector<std::unique_ptr<HttpClientConnection>> connections;
     std::map<String, String> defaultHeaders;
     std::function<void(HttpRequest &, HubHttpResponse &)> beforeSendHook;
+    std::vector<uint8_t> sendBuffer; // status line + headers + start of body, reused
+
+    struct ResponseCacheEntry {
+        int route;
+        String key;                // path + vary values (+ connection mode, which is in the stored bytes)
+        std::vector<uint8_t> data; // serialized response, sent as-is on a hit
+        u32_t storedMillis;
+        u32_t lastUsed;
+    };
+    std::vector<ResponseCacheEntry> responseCache;
+    size_t responseCacheBudget = 16384;
+    size_t responseCacheBytes = 0;
+    u32_t responseCacheClock = 0;
+    uint32_t responseCacheHits = 0;
+    uint32_t responseCacheMisses = 0;
     
     // Internal methods
     bool handleConnection(HttpClientConnection* connection);
-    bool respondToClient(WiFiClient &client, HubHttpResponse &response);
+    bool dispatchRequest(HttpClientConnection* connection, HttpRequest &req);
+    int findRoute(HttpRequest &req, int *pathMatch = nullptr) const;
+    void resolveRoute(HttpClientConnection *connection, HttpRequest &req) const;
+    void addRoute(const RoutePattern &rp);
+    int findRegisteredRoute(const String &method, const String &path) const;
+    String responseCacheKey(const HttpRequest &req, const ResponseCachePolicy &policy, bool keepOpen) const;
+    const ResponseCacheEntry* findCachedResponse(int route, const String &key);
+    const ResponseCacheEntry* storeCachedResponse(int route, const String &key, const HubHttpResponse &response);
+    static size_t entryCost(const ResponseCacheEntry &entry);
+    void evictResponseCacheUntil(size_t budget);
+    void dropCachedResponses(int route);
+    void resolveMiddlewares(RoutePattern &rp) const;
+    void addScopedMiddleware(const String &prefix, const HttpMiddleware &middleware);
+    void invokeRoute(const RoutePattern &rp, HttpRequest &req, HubHttpResponse &response);
+    void respondToClient(HttpClientConnection *connection, HubHttpResponse &response, bool headOnly = false);
+    void serializeHead(const HubHttpResponse &response, size_t contentLength, std::vector<uint8_t> &out);
     HubHttpResponse generateErrorResponse(int statusCode, const String &message);
     void applyCORS(HubHttpResponse &response);
-    void applyMiddlewares(HttpRequest &req, HubHttpResponse &response);
+    bool applyMiddlewares(HttpRequest &req, HubHttpResponse &response, const std::vector<HttpMiddleware> &chain);
     void applyDefaultHeaders(HubHttpResponse &response);
+    void applyConditionalResponse(const HttpRequest &req, HubHttpResponse &response);
     bool parseHeaders(HttpRequest &req, const String &method, const String &path);
     String getStatusText(int statusCode);
     void logRequest(const HttpRequest &req);
     void logResponse(const HubHttpResponse &response);
     String toLowerCase(const String &str) const;
     bool hasEnoughMemory() const;
-    bool matchPattern(const RoutePattern &rp, const String &method, const String &path, HttpRequest &req);
 };
 
 /**
@@ -0,0 +1,248 @@
+#include "http_static_files.h"
+#include "http_server.h"
+
+// ============================================================================
+// MIME Types
+// ============================================================================
+
+struct MimeTypeEntry {
+    const char *extension;
+    const char *type;
+};
+
+// Sorted by extension (binary searched)
+static const MimeTypeEntry MIME_TYPES[] = {
+    { "bin", "application/octet-stream" },
+    { "css", "text/css" },
+    { "csv", "text/csv" },
+    { "gif", "image/gif" },
+    { "htm", "text/html; charset=utf-8" },
+    { "html", "text/html; charset=utf-8" },
+    { "ico", "image/x-icon" },
+    { "jpeg", "image/jpeg" },
+    { "jpg", "image/jpeg" },
+    { "js", "application/javascript" },
+    { "json", "application/json" },
+    { "map", "application/json" },
+    { "mjs", "application/javascript" },
+    { "pdf", "application/pdf" },
+    { "png", "image/png" },
+    { "svg", "image/svg+xml" },
+    { "ttf", "font/ttf" },
+    { "txt", "text/plain; charset=utf-8" },
+    { "wasm", "application/wasm" },
+    { "webp", "image/webp" },
+    { "woff", "font/woff" },
+    { "woff2", "font/woff2" },
+    { "xml", "application/xml" },
+};
+
+const char* httpMimeType(const char *path, size_t length) {
+    size_t dot = length;
+    while (dot > 0 && path[dot - 1] != '.' && path[dot - 1] != '/') {
+        dot--;
+    }
+    if (dot == 0 || path[dot - 1] != '.') {
+        return "application/octet-stream";
+    }
+
+    char extension[8];
+    size_t extLength = length - dot;
+    if (extLength == 0 || extLength >= sizeof(extension)) {
+        return "application/octet-stream";
+    }
+    for (size_t i = 0; i < extLength; i++) {
+        extension[i] = static_cast<char>(tolower(static_cast<unsigned char>(path[dot + i])));
+    }
+    extension[extLength] = '\0';
+
+    size_t lo = 0;
+    size_t hi = sizeof(MIME_TYPES) / sizeof(MIME_TYPES[0]);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcmp(extension, MIME_TYPES[mid].extension);
+        if (cmp == 0) {
+            return MIME_TYPES[mid].type;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return "application/octet-stream";
+}
+
+// ============================================================================
+// Static File Routes
+// ============================================================================
+
+// Path of the requested file below the mount point, "" if it tries to climb out of it
+static String staticFilePath(const HttpRequest &req) {
+    const HttpSlice &rest = req.remainingPathView;
+    for (size_t i = 0; i + 1 < rest.length; i++) {
+        if (rest.data[i] == '.' && rest.data[i + 1] == '.' &&
+            (i == 0 || rest.data[i - 1] == '/') && (i + 2 == rest.length || rest.data[i + 2] == '/')) {
+            return String();
+        }
+    }
+    String path = "/";
+    path += rest.toString();
+    if (path.endsWith("/")) {
+        path += "index.html";
+    }
+    return path;
+}
+
+// Whether an Accept-Encoding header allows gzip ("gzip", "x-gzip" or "*" without q=0)
+static bool acceptsGzip(const HttpSlice &acceptEncoding) {
+    const char *p = acceptEncoding.data;
+    const char *end = p + acceptEncoding.length;
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == ',')) p++;
+        const char *token = p;
+        while (p < end && *p != ',' && *p != ';' && *p != ' ') p++;
+        HttpSlice coding(token, p - token);
+        bool rejected = false;
+        while (p < end && *p != ',') {
+            // Parameters - only "q=0" (or 0.0...) matters
+            if (*p == 'q' && p + 1 < end && p[1] == '=') {
+                const char *q = p + 2;
+                rejected = q < end && *q == '0';
+                while (++q < end && (*q == '.' || *q == '0')) {}
+                rejected = rejected && (q >= end || *q == ',' || *q == ' ' || *q == ';');
+            }
+            p++;
+        }
+        if (!rejected && (coding.equalsIgnoreCase("gzip") || coding.equalsIgnoreCase("x-gzip") || coding.equals("*"))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A precompressed sibling (name + ".gz") is sent as-is with Content-Encoding: gzip
+static void setEncodingHeaders(HubHttpResponse &response, bool hasGzip, bool sendGzip) {
+    if (sendGzip) {
+        response.setHeader("Content-Encoding", "gzip");
+    }
+    if (hasGzip) {
+        response.setHeader("Vary", "Accept-Encoding");
+    }
+}
+
+// Strong entity tag "<length>-<hash>" for bytes that never change (computed once, at registration)
+static String contentETag(const uint8_t *data, size_t length) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    char tag[24];
+    snprintf(tag, sizeof(tag), "\"%08x-%08x\"", static_cast<unsigned>(length), static_cast<unsigned>(hash));
+    return String(tag);
+}
+
+static String staticRoutePattern(const String &prefix) {
+    String pattern = prefix;
+    if (!pattern.endsWith("/")) pattern += "/";
+    return pattern + "*";
+}
+
+#if HUB_HTTP_HAS_FS
+// exists() first: on the ESP32 a failed open() logs an error, and most probes (".gz", typos) miss
+static fs::File openExisting(fs::FS &fs, const String &path) {
+    return fs.exists(path) ? fs.open(path, "r") : fs::File();
+}
+
+void HttpServer::serveStatic(const String &prefix, fs::FS &fs, const String &root, const String &cacheControl) {
+    String base = root;
+    while (base.endsWith("/")) {
+        base.remove(base.length() - 1);
+    }
+
+    on("GET", staticRoutePattern(prefix), [this, &fs, base, cacheControl](HttpRequest &req, HubHttpResponse &response) {
+        String relative = staticFilePath(req);
+        if (relative.length() == 0) {
+            response = generateErrorResponse(404, "Not Found");
+            return;
+        }
+        String path = base + relative;
+        fs::File file = openExisting(fs, path);
+        if (file && file.isDirectory()) {
+            file.close();
+            path += "/index.html";
+            file = openExisting(fs, path);
+        }
+        if (file && file.isDirectory()) {
+            file.close();
+        }
+        fs::File packed = openExisting(fs, path + ".gz");
+        bool hasGzip = packed && !packed.isDirectory();
+        bool sendGzip = hasGzip && acceptsGzip(req.getHeaderView(HTTP_HEADER_ACCEPT_ENCODING));
+        if (sendGzip) {
+            file = packed;
+        } else if (!file) {
+            // Only a compressed copy exists and the client cannot take it
+            response = generateErrorResponse(hasGzip ? 406 : 404, hasGzip ? "Not Acceptable" : "Not Found");
+            return;
+        }
+
+        // The file handle travels with the generator and is closed when the response is done
+        std::shared_ptr<fs::File> handle(new fs::File(file));
+        response.stream(httpMimeType(path.c_str(), path.length()), [handle](uint8_t *buffer, size_t maxLength) -> size_t {
+            return handle->read(buffer, maxLength);
+        }, static_cast<int32_t>(file.size()));
+        setEncodingHeaders(response, hasGzip, sendGzip);
+        // Size + modification time identify a file version without reading it
+        char tag[32];
+        snprintf(tag, sizeof(tag), "\"%x-%lx%s\"", static_cast<unsigned>(file.size()),
+                 static_cast<unsigned long>(file.getLastWrite()), sendGzip ? "-gz" : "");
+        response.etag(String(tag));
+        if (cacheControl.length() > 0) {
+            response.setHeader("Cache-Control", cacheControl);
+        }
+    });
+}
+#endif
+
+void HttpServer::serveStatic(const String &prefix, const HttpEmbeddedFile *files, size_t count, const String &cacheControl) {
+    std::vector<String> etags;
+    etags.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        etags.push_back(contentETag(files[i].data, files[i].length));
+    }
+
+    on("GET", staticRoutePattern(prefix), [this, files, count, etags, cacheControl](HttpRequest &req, HubHttpResponse &response) {
+        String path = staticFilePath(req);
+        String packedPath = path + ".gz";
+        const HttpEmbeddedFile *match = nullptr;
+        const HttpEmbeddedFile *packed = nullptr;
+        for (size_t i = 0; i < count && path.length() > 0; i++) {
+            if (path.equals(files[i].path)) {
+                match = &files[i];
+            } else if (packedPath.equals(files[i].path)) {
+                packed = &files[i];
+            }
+        }
+        bool sendGzip = packed != nullptr && acceptsGzip(req.getHeaderView(HTTP_HEADER_ACCEPT_ENCODING));
+        const HttpEmbeddedFile *source = sendGzip ? packed : match;
+        if (source == nullptr) {
+            response = generateErrorResponse(packed != nullptr ? 406 : 404, packed != nullptr ? "Not Acceptable" : "Not Found");
+            return;
+        }
+        // The type is the uncompressed file's (an explicit type on either entry wins)
+        const char *type = source->contentType;
+        if (type == nullptr && match != nullptr) {
+            type = match->contentType;
+        }
+        if (type == nullptr) {
+            type = httpMimeType(path.c_str(), path.length());
+        }
+        response.staticBody(type, source->data, source->length);
+        response.etag(etags[source - files]);
+        setEncodingHeaders(response, packed != nullptr, sendGzip);
+        if (cacheControl.length() > 0) {
+            response.setHeader("Cache-Control", cacheControl);
+        }
+    });
+}
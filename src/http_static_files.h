@@ -0,0 +1,43 @@
+#ifndef HUB_HTTP_STATIC_FILES_H
+#define HUB_HTTP_STATIC_FILES_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <FS.h>
+#define HUB_HTTP_HAS_FS 1
+#else
+#define HUB_HTTP_HAS_FS 0
+#endif
+
+/**
+ * @brief A file linked into the firmware image, for HttpServer::serveStatic()
+ *
+ * With PlatformIO, files listed in board_build.embed_files are available as
+ * _binary_<path>_start / _binary_<path>_end symbols:
+ *
+ *   extern const uint8_t index_start[] asm("_binary_data_www_index_html_start");
+ *   extern const uint8_t index_end[] asm("_binary_data_www_index_html_end");
+ *
+ *   static const HttpEmbeddedFile UI_FILES[] = {
+ *       { "/index.html", index_start, (size_t)(index_end - index_start), nullptr },
+ *   };
+ *
+ * The data is sent straight from flash, without being copied into RAM first.
+ */
+struct HttpEmbeddedFile {
+    const char *path;        // request path below the serveStatic() prefix, e.g. "/index.html"
+    const uint8_t *data;
+    size_t length;
+    const char *contentType; // nullptr to pick one from the path's extension
+};
+
+/**
+ * @brief Look up the Content-Type for a file name by its extension (case-insensitive)
+ * @param path File name or path
+ * @param length Length of path
+ * @return The MIME type, "application/octet-stream" for unknown extensions
+ */
+const char* httpMimeType(const char *path, size_t length);
+
+#endif // HUB_HTTP_STATIC_FILES_H
@@ -0,0 +1,148 @@
+#ifndef HUB_HTTP_STATIC_ROUTER_H
+#define HUB_HTTP_STATIC_ROUTER_H
+
+#include "http_server.h"
+
+/*
+ * Compile-time route tables
+ *
+ * For firmware whose routes are all known at build time. The table is a type - route
+ * patterns are const char arrays (kept in flash) and handlers are plain functions - so
+ * nothing is registered or allocated at startup and each route's matcher is inlined
+ * against its own pattern. Works with -std=c++11.
+ *
+ *   static const char STATUS[] = "/api/status";
+ *   static const char ITEM[] = "/api/item/:id";
+ *
+ *   typedef StaticRouter<
+ *       StaticRoute<HTTP_METHOD_GET, STATUS, getStatus>,
+ *       StaticRoute<HTTP_METHOD_PUT, ITEM, putItem>
+ *   > AppRoutes;
+ *
+ *   server.useStaticRoutes<AppRoutes>();
+ *
+ * Routes are tried in the order listed and the first match wins. Handlers are called
+ * with a null context.
+ */
+
+/**
+ * @brief Matches a request path against a route pattern without allocating
+ *
+ * Supports static segments, :params and a final "*" wildcard, like HttpServer::on().
+ * Fills in the request's paramViews and remainingPathView on success.
+ */
+struct StaticRoutePattern {
+    static bool match(const char *pattern, HttpRequest &req) {
+        req.numParamViews = 0;
+        req.remainingPathView = HttpSlice();
+        const char *p = req.pathView.data;
+        const char *end = req.pathView.data + req.pathView.length;
+        while (true) {
+            while (*pattern == '/') pattern++;
+            while (p < end && *p == '/') p++;
+            if (*pattern == '\0') {
+                return p == end;
+            }
+            if (pattern[0] == '*' && (pattern[1] == '\0' || (pattern[1] == '*' && pattern[2] == '\0'))) {
+                req.remainingPathView = HttpSlice(p, end - p);
+                return true;
+            }
+            if (p == end) {
+                return false;
+            }
+            const char *segEnd = p;
+            while (segEnd < end && *segEnd != '/') segEnd++;
+            if (*pattern == ':') {
+                const char *name = ++pattern;
+                while (*pattern != '\0' && *pattern != '/') pattern++;
+                if (req.numParamViews < HttpRequest::MAX_PARAMS) {
+                    HttpParamSlice &param = req.paramViews[req.numParamViews++];
+                    param.name = HttpSlice(name, pattern - name);
+                    param.value = HttpSlice(p, segEnd - p);
+                }
+            } else {
+                while (p < segEnd && *pattern == *p) {
+                    pattern++;
+                    p++;
+                }
+                if (p != segEnd || (*pattern != '\0' && *pattern != '/')) {
+                    return false;
+                }
+            }
+            p = segEnd;
+        }
+    }
+};
+
+/**
+ * @brief One entry of a StaticRouter
+ * @tparam Method Method to match (HTTP_METHOD_ANY for all)
+ * @tparam Pattern Path pattern - a const char array with static storage
+ * @tparam Handler Function filling in the response (called with a null context)
+ */
+template <HttpMethod Method, const char *Pattern, RouteHandlerFn Handler>
+struct StaticRoute {
+    static bool match(HttpRequest &req) {
+        // Integer compare first so most routes are rejected without touching the path.
+        // GET routes answer HEAD too, as in HttpRouter.
+        if (Method != HTTP_METHOD_ANY && req.methodId != Method &&
+            !(Method == HTTP_METHOD_GET && req.methodId == HTTP_METHOD_HEAD)) {
+            return false;
+        }
+        return StaticRoutePattern::match(Pattern, req);
+    }
+
+    static void invoke(HttpRequest &req, HubHttpResponse &response) {
+        Handler(req, response, nullptr);
+    }
+};
+
+template <int Index, typename... Routes>
+struct StaticRouteList;
+
+template <int Index>
+struct StaticRouteList<Index> {
+    static int find(HttpRequest &) { return -1; }
+    static void invoke(int, HttpRequest &, HubHttpResponse &) {}
+};
+
+template <int Index, typename First, typename... Rest>
+struct StaticRouteList<Index, First, Rest...> {
+    static int find(HttpRequest &req) {
+        return First::match(req) ? Index : StaticRouteList<Index + 1, Rest...>::find(req);
+    }
+
+    static void invoke(int index, HttpRequest &req, HubHttpResponse &response) {
+        if (index == Index) {
+            First::invoke(req, response);
+        } else {
+            StaticRouteList<Index + 1, Rest...>::invoke(index, req, response);
+        }
+    }
+};
+
+/**
+ * @brief A route table fixed at compile time
+ * @tparam Routes StaticRoute entries, tried in order
+ */
+template <typename... Routes>
+struct StaticRouter {
+    static const size_t SIZE = sizeof...(Routes);
+
+    /**
+     * @brief Find the first route matching the request
+     * @return Index of the route or -1
+     */
+    static int find(HttpRequest &req) {
+        return StaticRouteList<0, Routes...>::find(req);
+    }
+
+    /**
+     * @brief Call the handler of the route returned by find()
+     */
+    static void invoke(int index, HttpRequest &req, HubHttpResponse &response) {
+        StaticRouteList<0, Routes...>::invoke(index, req, response);
+    }
+};
+
+#endif // HUB_HTTP_STATIC_ROUTER_H
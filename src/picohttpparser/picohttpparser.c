@@ -52,6 +52,58 @@
 
 #define IS_PRINTABLE_ASCII(c) ((unsigned char)(c)-040u < 0137u)
 
+/* Targets without SSE4.2 that load unaligned words at full speed (x86, ARMv7+/AArch64) scan a machine
+ * word at a time instead of byte by byte. Xtensa and RISC-V ESP32 cores trap or emulate unaligned loads;
+ * the aligned variant (byte prologue, then aligned words) is slower than the byte loops on short requests
+ * in bench/, so those targets keep the byte loops unless PICOHTTPPARSER_SWAR_ALIGNED is defined.
+ * Define PICOHTTPPARSER_DISABLE_SWAR to always use the byte loops. */
+#if !defined(__SSE4_2__) && !defined(PICOHTTPPARSER_DISABLE_SWAR)
+#if defined(PICOHTTPPARSER_SWAR_ALIGNED)
+#define PHR_USE_SWAR 1
+#elif defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || defined(__ARM_FEATURE_UNALIGNED)
+#define PHR_USE_SWAR 1
+#define PHR_WORD_UNALIGNED 1
+#endif
+#endif
+
+#ifdef PHR_USE_SWAR
+
+typedef size_t phr_word_t;
+#define PHR_WORD_ONES ((phr_word_t)-1 / 0xff)
+#define PHR_WORD_HIGHS (PHR_WORD_ONES << 7)
+/* sets the MSB of every byte of x outside [lower, 0176] (a byte below `lower`, DEL or a byte with the MSB
+ * set); the lowest flagged byte is always exact, higher flags may be borrow/carry artefacts */
+#define PHR_WORD_OUTSIDE(x, lower) ((((x) - PHR_WORD_ONES * (lower)) | (x) | ((x) + PHR_WORD_ONES)) & PHR_WORD_HIGHS)
+#define PHR_IS_OUTSIDE(c, lower) ((unsigned char)(c) - (unsigned)(lower) >= 0177u - (unsigned)(lower))
+
+/* Skips bytes in [lower, 0176] a word at a time. Returns the first byte outside that range, or the
+ * start of the tail shorter than a word when none was found; the caller finishes bytewise. */
+static const char *skip_printable_words(const char *buf, const char *buf_end, unsigned char lower)
+{
+#ifndef PHR_WORD_UNALIGNED
+    while (((uintptr_t)buf & (sizeof(phr_word_t) - 1)) != 0) {
+        if (buf == buf_end || PHR_IS_OUTSIDE(*buf, lower))
+            return buf;
+        ++buf;
+    }
+#endif
+    while (likely(buf_end - buf >= (ptrdiff_t)sizeof(phr_word_t))) {
+        phr_word_t w;
+        memcpy(&w, buf, sizeof(w));
+        phr_word_t flags = PHR_WORD_OUTSIDE(w, lower);
+        if (flags != 0) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return buf + (sizeof(phr_word_t) == 8 ? __builtin_ctzll(flags) : __builtin_ctz((unsigned)flags)) / 8;
+#else
+            return buf; /* the caller rescans the word */
+#endif
+        }
+        buf += sizeof(phr_word_t);
+    }
+    return buf;
+}
+#endif
+
 #define CHECK_EOF()                                                                                                                \
     if (buf == buf_end) {                                                                                                          \
         *ret = -2;                                                                                                                 \
@@ -68,12 +120,18 @@
     CHECK_EOF();                                                                                                                   \
     EXPECT_CHAR_NO_CHECK(ch);
 
+#ifdef PHR_USE_SWAR
+#define ADVANCE_TOKEN_FAST(buf, buf_end, ranges, found) (*(found) = 0, (void)(ranges), skip_printable_words(buf, buf_end, 041))
+#else
+#define ADVANCE_TOKEN_FAST(buf, buf_end, ranges, found) findchar_fast(buf, buf_end, ranges, 4, found)
+#endif
+
 #define ADVANCE_TOKEN(tok, toklen)                                                                                                 \
     do {                                                                                                                           \
         const char *tok_start = buf;                                                                                               \
         static const char ALIGNED(16) ranges2[16] = "\000\040\177\177";                                                            \
         int found2;                                                                                                                \
-        buf = findchar_fast(buf, buf_end, ranges2, 4, &found2);                                                                    \
+        buf = ADVANCE_TOKEN_FAST(buf, buf_end, ranges2, &found2);                                                                  \
         if (!found2) {                                                                                                             \
             CHECK_EOF();                                                                                                           \
         }                                                                                                                          \
@@ -143,6 +201,16 @@ static const char *get_token_to_eol(const char *buf, const char *buf_end, const
     buf = findchar_fast(buf, buf_end, ranges1, 6, &found);
     if (found)
         goto FOUND_CTL;
+#elif defined(PHR_USE_SWAR)
+    /* skip printable words; HT and bytes with the MSB set stop the skip but are part of the value */
+    while (1) {
+        buf = skip_printable_words(buf, buf_end, 040);
+        if (buf == buf_end || IS_PRINTABLE_ASCII(*buf))
+            break; /* tail shorter than a word (or a big-endian word to rescan) */
+        if ((likely((unsigned char)*buf < '\040') && likely(*buf != '\011')) || unlikely(*buf == '\177'))
+            goto FOUND_CTL;
+        ++buf;
+    }
 #else
     /* find non-printable char within the next 8 bytes, this is the hottest code; manually inlined */
     while (likely(buf_end - buf >= 8)) {
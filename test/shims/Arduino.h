@@ -0,0 +1,117 @@
+// Minimal Arduino core for compiling the server sources on a host (tests and benchmarks only)
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <strings.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef uint32_t u32_t;
+typedef uint64_t u64_t;
+
+unsigned long millis();
+void delay(unsigned long ms);
+void yield();
+
+// Fake clock - millis() only moves when a test advances it
+void shimAdvanceMillis(unsigned long ms);
+
+class String {
+public:
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const char *c, unsigned int n) : s(c, n) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned int v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(long long v) : s(std::to_string(v)) {}
+    String(unsigned long long v) : s(std::to_string(v)) {}
+    String(double v) : s(std::to_string(v)) {}
+    String(unsigned int v, unsigned char base) { format(base == 16 ? "%x" : "%u", v); }
+    String(unsigned long v, unsigned char base) { format(base == 16 ? "%lx" : "%lu", v); }
+
+    unsigned int length() const { return s.size(); }
+    const char* c_str() const { return s.c_str(); }
+    bool reserve(unsigned int n) { s.reserve(n); return true; }
+    bool isEmpty() const { return s.empty(); }
+
+    bool equals(const String &o) const { return s == o.s; }
+    bool equalsIgnoreCase(const String &o) const { return strcasecmp(s.c_str(), o.s.c_str()) == 0; }
+    bool startsWith(const String &o) const { return s.compare(0, o.s.size(), o.s) == 0; }
+    bool startsWith(const String &o, unsigned int offset) const { return offset <= s.size() && s.compare(offset, o.s.size(), o.s) == 0; }
+    bool endsWith(const String &o) const { return s.size() >= o.s.size() && s.compare(s.size() - o.s.size(), o.s.size(), o.s) == 0; }
+    int indexOf(char c, unsigned int from = 0) const { return position(s.find(c, from)); }
+    int indexOf(const String &o, unsigned int from = 0) const { return position(s.find(o.s, from)); }
+    int lastIndexOf(char c) const { return position(s.rfind(c)); }
+    String substring(unsigned int from) const { return from < s.size() ? String(s.c_str() + from) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < s.size() && from < to ? String(s.c_str() + from, std::min<size_t>(to, s.size()) - from) : String(); }
+    char charAt(unsigned int i) const { return s[i]; }
+    char operator[](unsigned int i) const { return s[i]; }
+    char& operator[](unsigned int i) { return s[i]; }
+    long toInt() const { return atol(s.c_str()); }
+
+    void remove(unsigned int i) { if (i < s.size()) s.erase(i); }
+    void remove(unsigned int i, unsigned int n) { if (i < s.size()) s.erase(i, n); }
+    void toLowerCase() { for (size_t i = 0; i < s.size(); i++) s[i] = tolower(s[i]); }
+    void toUpperCase() { for (size_t i = 0; i < s.size(); i++) s[i] = toupper(s[i]); }
+    void trim() {
+        size_t a = s.find_first_not_of(" \t\r\n");
+        s = a == std::string::npos ? std::string() : s.substr(a, s.find_last_not_of(" \t\r\n") - a + 1);
+    }
+    bool concat(const char *c, unsigned int n) { s.append(c, n); return true; }
+    bool concat(const String &o) { s += o.s; return true; }
+    bool concat(char c) { s += c; return true; }
+
+    String& operator+=(const String &o) { s += o.s; return *this; }
+    String& operator+=(const char *o) { s += o; return *this; }
+    String& operator+=(char o) { s += o; return *this; }
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return s == o; }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator!=(const char *o) const { return s != o; }
+    bool operator<(const String &o) const { return s < o.s; }
+
+    friend String operator+(const String &a, const String &b) { String r = a; r.s += b.s; return r; }
+    friend String operator+(const String &a, const char *b) { String r = a; r.s += b; return r; }
+    friend String operator+(const char *a, const String &b) { String r(a); r.s += b.s; return r; }
+
+private:
+    std::string s;
+
+    static int position(size_t p) { return p == std::string::npos ? -1 : static_cast<int>(p); }
+    template <typename T> void format(const char *fmt, T v) { char b[24]; snprintf(b, sizeof(b), fmt, v); s = b; }
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t *buffer, size_t size) { return size; }
+    virtual int availableForWrite() { return 0; }
+    size_t write(const char *buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+    size_t print(const String &s) { return write(s.c_str(), s.length()); }
+    size_t print(const char *s) { return write(s, strlen(s)); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned int v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t println() { return write("\r\n", 2); }
+    size_t println(const String &s) { return print(s) + println(); }
+    size_t println(const char *s) { return print(s) + println(); }
+    size_t println(int v) { return print(v) + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+};
+
+extern Print Serial;
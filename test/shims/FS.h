@@ -0,0 +1,50 @@
+// fs::FS over a host directory, for serveStatic()
+//
+// Host builds serve directories through the same fs::FS code as the device. The sockets here
+// are in-memory (MockSocket), so there is no descriptor an mmap/sendfile() path could use.
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+#include <sys/stat.h>
+
+namespace fs {
+
+class File {
+public:
+    File() {}
+    File(const std::string &path, bool directory, size_t size, time_t mtime);
+
+    explicit operator bool() const { return static_cast<bool>(impl); }
+    bool isDirectory() const { return impl && impl->directory; }
+    size_t size() const { return impl ? impl->size : 0; }
+    time_t getLastWrite() const { return impl ? impl->mtime : 0; }
+    size_t read(uint8_t *buffer, size_t size);
+    void close() { impl.reset(); }
+
+private:
+    struct Impl {
+        FILE *file = nullptr;
+        bool directory = false;
+        size_t size = 0;
+        time_t mtime = 0;
+        ~Impl() { if (file) fclose(file); }
+    };
+    std::shared_ptr<Impl> impl;
+};
+
+class FS {
+public:
+    explicit FS(const std::string &root) : root(root) {}
+
+    bool exists(const String &path);
+    File open(const String &path, const char *mode = "r");
+
+    int opens = 0;       // open() calls
+    int failedOpens = 0; // open() calls for missing paths (the ESP32 VFS logs an error for each)
+
+private:
+    std::string root;
+};
+
+} // namespace fs
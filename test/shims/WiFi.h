@@ -0,0 +1,62 @@
+// In-memory sockets standing in for the ESP32 WiFi stack
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <memory>
+
+// One client connection as the test sees it: bytes the client sent, bytes the server wrote
+struct MockSocket {
+    std::string received;          // not yet read by the server
+    std::string sent;              // written by the server
+    bool open = true;              // false once the client hung up
+    size_t maxRead = SIZE_MAX;     // bytes a single read() may return
+    size_t maxWrite = SIZE_MAX;    // bytes a single write() accepts
+    size_t writeSpace = SIZE_MAX;  // bytes the send buffer takes until the test frees more (a slow reader)
+    bool reportsWriteSpace = true; // false: availableForWrite() returns 0, like Print's default
+    int writes = 0;                // write() calls that accepted data
+    int segments = 0;              // TCP segments those writes leave in when each is pushed at once (TCP_NODELAY)
+
+    static const size_t TCP_MSS = 1436; // lwIP's default on the ESP32
+};
+
+class WiFiClient : public Stream {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(const std::shared_ptr<MockSocket> &socket) : socket(socket) {}
+
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int availableForWrite() override;
+    uint8_t connected();
+    void stop();
+    void flush() {}
+    void setNoDelay(bool) {}
+    explicit operator bool() const { return static_cast<bool>(socket); }
+
+private:
+    std::shared_ptr<MockSocket> socket;
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port = 80) {}
+    void begin() {}
+    void stop() {}
+    WiFiClient accept();
+    WiFiClient available() { return accept(); }
+
+    // Connections waiting to be accepted (shared by every server instance)
+    static std::deque<WiFiClient> pending;
+};
+
+class WiFiClass {
+public:
+    int scanNetworks() { return 0; }
+    String SSID(int) { return String(); }
+    int RSSI(int) { return 0; }
+};
+
+extern WiFiClass WiFi;
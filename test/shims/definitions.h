@@ -0,0 +1,9 @@
+// Stand-in for hub-robot-core's definitions.h
+#pragma once
+
+#include <Arduino.h>
+
+class CachingPrinter : public Print {
+public:
+    std::string tail(size_t lines) { return std::string(); }
+};
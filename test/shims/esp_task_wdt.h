@@ -0,0 +1,3 @@
+#pragma once
+
+inline void esp_task_wdt_reset() {}
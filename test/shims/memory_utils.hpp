@@ -0,0 +1,6 @@
+// Stand-in for hub-robot-core's memory_utils.hpp
+#pragma once
+
+#include <cstddef>
+
+size_t freeRam();
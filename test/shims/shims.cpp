@@ -0,0 +1,142 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <FS.h>
+#include <definitions.h>
+#include <memory_utils.hpp>
+#include <string_utils.hpp>
+
+static unsigned long fakeMillis = 0;
+
+unsigned long millis() { return fakeMillis; }
+void delay(unsigned long ms) { fakeMillis += ms; }
+void yield() {}
+void shimAdvanceMillis(unsigned long ms) { fakeMillis += ms; }
+
+Print Serial;
+WiFiClass WiFi;
+
+size_t freeRam() { return 200 * 1024; }
+
+std::vector<std::string> split(const std::string &s, char delimiter) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = s.find(delimiter, start);
+        parts.push_back(s.substr(start, end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+size_t utf8ByteLength(const String &s) {
+    return s.length();
+}
+
+// ============================================================================
+// WiFiClient / WiFiServer
+// ============================================================================
+
+std::deque<WiFiClient> WiFiServer::pending;
+
+WiFiClient WiFiServer::accept() {
+    if (pending.empty()) {
+        return WiFiClient();
+    }
+    WiFiClient client = pending.front();
+    pending.pop_front();
+    return client;
+}
+
+int WiFiClient::available() {
+    return socket ? static_cast<int>(std::min(socket->received.size(), socket->maxRead)) : 0;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size) {
+    if (!socket) {
+        return -1;
+    }
+    size_t n = std::min(std::min(size, socket->received.size()), socket->maxRead);
+    if (n == 0) {
+        return socket->open ? 0 : -1;
+    }
+    memcpy(buffer, socket->received.data(), n);
+    socket->received.erase(0, n);
+    return static_cast<int>(n);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+    if (!socket || !socket->open) {
+        return 0;
+    }
+    size_t n = std::min(std::min(size, socket->maxWrite), socket->writeSpace);
+    if (socket->writeSpace != SIZE_MAX) {
+        socket->writeSpace -= n;
+    }
+    if (n > 0) {
+        socket->sent.append(reinterpret_cast<const char*>(buffer), n);
+        socket->writes++;
+        socket->segments += static_cast<int>((n + MockSocket::TCP_MSS - 1) / MockSocket::TCP_MSS);
+    }
+    return n;
+}
+
+int WiFiClient::availableForWrite() {
+    if (!socket || !socket->reportsWriteSpace) {
+        return 0;
+    }
+    return static_cast<int>(std::min<size_t>(std::min(socket->maxWrite, socket->writeSpace), 1 << 30));
+}
+
+uint8_t WiFiClient::connected() {
+    return socket && (socket->open || !socket->received.empty());
+}
+
+void WiFiClient::stop() {
+    if (socket) {
+        socket->open = false;
+    }
+}
+
+// ============================================================================
+// fs::FS
+// ============================================================================
+
+namespace fs {
+
+File::File(const std::string &path, bool directory, size_t size, time_t mtime) : impl(new Impl()) {
+    impl->directory = directory;
+    impl->size = size;
+    impl->mtime = mtime;
+    if (!directory) {
+        impl->file = fopen(path.c_str(), "rb");
+    }
+}
+
+size_t File::read(uint8_t *buffer, size_t size) {
+    return impl && impl->file ? fread(buffer, 1, size, impl->file) : 0;
+}
+
+bool FS::exists(const String &path) {
+    struct stat st;
+    return stat((root + path.c_str()).c_str(), &st) == 0;
+}
+
+File FS::open(const String &path, const char *mode) {
+    opens++;
+    std::string full = root + path.c_str();
+    struct stat st;
+    if (stat(full.c_str(), &st) != 0) {
+        failedOpens++;
+        return File();
+    }
+    return File(full, S_ISDIR(st.st_mode), st.st_size, st.st_mtime);
+}
+
+} // namespace fs
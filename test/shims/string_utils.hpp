@@ -0,0 +1,9 @@
+// Stand-in for hub-robot-core's string_utils.hpp
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+std::vector<std::string> split(const std::string &s, char delimiter);
+size_t utf8ByteLength(const String &s);
@@ -0,0 +1,82 @@
+// Chunked request bodies split across reads at every byte offset
+#include "test_util.h"
+
+static const std::string CHUNKED_POST =
+    "POST /echo HTTP/1.1\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "5\r\nhello\r\n"
+    "1;ext=1\r\n \r\n"
+    "b\r\nworld-12345\r\n"
+    "0\r\n"
+    "Trailer: x\r\n"
+    "\r\n"
+    "GET /after HTTP/1.1\r\n"
+    "\r\n";
+
+// Feed `request` to a new connection in three parts and return the server's output
+static std::string sendInParts(HttpServer &server, const std::string &request, size_t cut1, size_t cut2) {
+    std::shared_ptr<MockSocket> socket = connectClient(request.substr(0, cut1));
+    server.tick();
+    socket->received += request.substr(cut1, cut2 - cut1);
+    server.tick();
+    socket->received += request.substr(cut2);
+    runTicks(server, 3);
+    socket->open = false;
+    server.tick();
+    return socket->sent;
+}
+
+int main() {
+    HttpServer server;
+    server.setKeepAlive(true);
+    server.on("POST", "/echo", [](HttpRequest &req) {
+        return HubHttpResponse(200, "[" + req.body + "]");
+    });
+    String uploaded;
+    server.onUpload("POST", "/upload", [&uploaded](HttpRequest &req, const uint8_t *data, size_t length) {
+        uploaded.concat(reinterpret_cast<const char*>(data), length);
+        return true;
+    }, [&uploaded](HttpRequest &req) {
+        return HubHttpResponse(200, "{" + uploaded + "}");
+    });
+    server.on("GET", "/after", [](HttpRequest &req) {
+        return HubHttpResponse(200, "after");
+    });
+    server.begin();
+
+    // Buffered route: every single split point, and a second split every few bytes after it
+    std::string expected = sendInParts(server, CHUNKED_POST, CHUNKED_POST.size(), CHUNKED_POST.size());
+    CHECK(contains(expected, "[hello world-12345]"));
+    CHECK(contains(expected, "after"));
+    size_t mismatches = 0;
+    for (size_t cut1 = 0; cut1 <= CHUNKED_POST.size(); cut1++) {
+        for (size_t cut2 = cut1; cut2 <= CHUNKED_POST.size(); cut2 += 5) {
+            if (sendInParts(server, CHUNKED_POST, cut1, cut2) != expected) {
+                if (mismatches++ == 0) {
+                    printf("buffered body differs when split at %zu / %zu\n", cut1, cut2);
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // Streaming upload route: the pieces handed to the body handler add up to the decoded body
+    std::string upload = CHUNKED_POST;
+    upload.replace(upload.find("/echo"), 5, "/upload");
+    for (size_t cut1 = 0; cut1 <= upload.size(); cut1++) {
+        uploaded = "";
+        std::string out = sendInParts(server, upload, cut1, cut1 + (upload.size() - cut1) / 2);
+        if (!contains(out, "{hello world-12345}") || !contains(out, "after")) {
+            printf("upload differs when split at %zu:\n%s\n", cut1, out.c_str());
+            CHECK(false);
+            break;
+        }
+    }
+
+    // Malformed chunk sizes are rejected
+    std::string bad = exchange(server, "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\nhello\r\n0\r\n\r\n");
+    CHECK(contains(bad, "400"));
+
+    return testResult("test_chunked");
+}
@@ -0,0 +1,75 @@
+// ETags and If-None-Match: matching requests get a header-only 304
+#include "test_util.h"
+
+static std::string get(HttpServer &server, const std::string &path, const std::string &headers = "") {
+    return exchange(server, "GET " + path + " HTTP/1.1\r\n" + headers + "\r\n");
+}
+
+static std::string bodyOf(const std::string &response) {
+    size_t headEnd = response.find("\r\n\r\n");
+    return headEnd == std::string::npos ? std::string() : response.substr(headEnd + 4);
+}
+
+int main() {
+    HttpServer server;
+    server.on("GET", "/doc", [](HttpRequest &req) {
+        HubHttpResponse response(200, "hello");
+        response.setHeader("Content-Type", "text/plain");
+        response.setHeader("Cache-Control", "max-age=60");
+        response.setHeader("Vary", "Accept-Encoding");
+        response.etag();
+        return response;
+    });
+    server.on("POST", "/doc", [](HttpRequest &req) {
+        return HubHttpResponse(200, "hello").etag();
+    });
+    server.on("GET", "/versioned", [](HttpRequest &req) {
+        return HubHttpResponse(200, "v1 body").etag("W/\"v1\"");
+    });
+    server.on("GET", "/plain", [](HttpRequest &req) {
+        return HubHttpResponse(200, "no tag");
+    });
+    server.begin();
+
+    // etag() hashes a String body: "<length>-<FNV-1a>"
+    const std::string tag = "\"00000005-4f9f2cab\"";
+    std::string out = get(server, "/doc");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(contains(out, "ETag: " + tag + "\r\n"));
+    CHECK(bodyOf(out) == "hello");
+
+    // Strong, weak and "*" matches, alone or in a list
+    const std::string matches[] = { tag, "W/" + tag, "*", "\"other\", " + tag };
+    for (size_t i = 0; i < sizeof(matches) / sizeof(matches[0]); i++) {
+        out = get(server, "/doc", "If-None-Match: " + matches[i] + "\r\n");
+        CHECK(contains(out, "HTTP/1.1 304 Not Modified\r\n"));
+        // Validators and caching headers stay, the representation headers and body go
+        CHECK(contains(out, "ETag: " + tag + "\r\n"));
+        CHECK(contains(out, "Cache-Control: max-age=60\r\n"));
+        CHECK(contains(out, "Vary: Accept-Encoding\r\n"));
+        CHECK(!contains(out, "Content-Type"));
+        CHECK(!contains(out, "Content-Length"));
+        CHECK(bodyOf(out).empty());
+    }
+
+    // A different tag, no ETag or a non-GET method gets the full response
+    out = get(server, "/doc", "If-None-Match: \"00000005-00000000\"\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(bodyOf(out) == "hello");
+    out = get(server, "/plain", "If-None-Match: *\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(!contains(out, "ETag"));
+    out = exchange(server, "POST /doc HTTP/1.1\r\nIf-None-Match: " + tag + "\r\nContent-Length: 0\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+
+    // A handler-supplied weak tag compares weakly against a strong one
+    out = get(server, "/versioned", "If-None-Match: \"v1\"\r\n");
+    CHECK(contains(out, "HTTP/1.1 304"));
+    CHECK(contains(out, "ETag: W/\"v1\"\r\n"));
+
+    // HEAD revalidates the same way
+    out = exchange(server, "HEAD /doc HTTP/1.1\r\nIf-None-Match: " + tag + "\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 304"));
+
+    return testResult("test_conditional");
+}
@@ -0,0 +1,48 @@
+// Content-Length framing: overflowing and conflicting values must not let a body smuggle a request
+#include "test_util.h"
+
+int main() {
+    HttpServer server;
+    server.setKeepAlive(true);
+    int adminCalls = 0;
+    server.on("POST", "/echo", [](HttpRequest &req) {
+        return HubHttpResponse(200, "len=" + String(static_cast<unsigned long>(req.body.length())));
+    });
+    server.on("GET", "/admin", [&adminCalls](HttpRequest &req) {
+        adminCalls++;
+        return HubHttpResponse(200, "admin");
+    });
+    server.begin();
+
+    // Well-formed body followed by a pipelined request
+    std::string out = exchange(server, "POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nhelloGET /admin HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "len=5"));
+    CHECK(adminCalls == 1);
+
+    // 2^64 + 1 used to wrap around to a 1 byte body, leaving "GET /admin" as the next request
+    adminCalls = 0;
+    std::shared_ptr<MockSocket> socket = connectClient("POST /echo HTTP/1.1\r\nContent-Length: 18446744073709551617\r\n\r\nxGET /admin HTTP/1.1\r\n\r\n");
+    runTicks(server);
+    CHECK(contains(socket->sent, "400 Bad Request"));
+    CHECK(countOf(socket->sent, "HTTP/1.1 ") == 1);
+    CHECK(!socket->open); // the server closed the connection
+    CHECK(adminCalls == 0);
+
+    out = exchange(server, "POST /echo HTTP/1.1\r\nContent-Length: 99999999999999999999999999\r\n\r\nx");
+    CHECK(contains(out, "400 Bad Request"));
+
+    // Repeated Content-Length: the same value is fine, different values are rejected
+    out = exchange(server, "POST /echo HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\nabc");
+    CHECK(contains(out, "len=3"));
+    out = exchange(server, "POST /echo HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 24\r\n\r\nxGET /admin HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "400 Bad Request"));
+    CHECK(adminCalls == 0);
+    out = exchange(server, "POST /echo HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1x\r\n\r\nx");
+    CHECK(contains(out, "400 Bad Request"));
+
+    // Not a number
+    out = exchange(server, "POST /echo HTTP/1.1\r\nContent-Length: -1\r\n\r\nx");
+    CHECK(contains(out, "400 Bad Request"));
+
+    return testResult("test_content_length");
+}
@@ -0,0 +1,76 @@
+// What middleware sees of the request, and how its chain ends
+#include "test_util.h"
+
+int main() {
+    HttpServer server;
+    String seen;
+    server.use(MiddlewareHandlerBool([&seen](HttpRequest &req, HubHttpResponse &response) {
+        std::map<String, String>::const_iterator token = req.headers.find("X-Token");
+        std::map<String, String>::const_iterator unit = req.query.find("unit");
+        std::map<String, String>::const_iterator id = req.params.find("id");
+        seen = req.method + " " + req.path;
+        seen += " token=" + (token != req.headers.end() ? token->second : String("-"));
+        seen += " unit=" + (unit != req.query.end() ? unit->second : String("-"));
+        seen += " id=" + (id != req.params.end() ? id->second : String("-"));
+        seen += " get=" + req.getHeader("X-Token") + "/" + req.getParam("id");
+        return true;
+    }));
+    server.on("PUT", "/api/item/:id", [](HttpRequest &req) {
+        return HubHttpResponse(200, "ok");
+    });
+    server.begin();
+
+    // Default mode: the request is materialized before any middleware runs
+    std::string out = exchange(server, "PUT /api/item/42?unit=mm HTTP/1.1\r\nX-Token: abc\r\nContent-Length: 0\r\n\r\n");
+    CHECK(contains(out, "200 OK"));
+    CHECK(seen == "PUT /api/item/42 token=abc unit=mm id=42 get=abc/42");
+
+    // Zero-copy mode: the String maps stay empty, the accessors still work
+    server.setZeroCopyRequests(true);
+    exchange(server, "PUT /api/item/7?unit=cm HTTP/1.1\r\nX-Token: xyz\r\nContent-Length: 0\r\n\r\n");
+    CHECK(contains(seen.c_str(), "get=xyz/7"));
+
+    // Returning false ends the chain and skips the handler - the middleware's response is sent
+    HttpServer guarded;
+    int handlerCalls = 0, laterCalls = 0, scopedCalls = 0;
+    guarded.use(MiddlewareHandlerBool([](HttpRequest &req, HubHttpResponse &response) {
+        if (req.getHeader("Authorization").length() > 0) {
+            return true;
+        }
+        response.setStatus(401);
+        response.text("denied");
+        return false;
+    }));
+    guarded.use(MiddlewareHandlerBool([&laterCalls](HttpRequest &req, HubHttpResponse &response) {
+        laterCalls++;
+        return true;
+    }));
+    guarded.use("/api/admin", MiddlewareHandlerBool([&scopedCalls](HttpRequest &req, HubHttpResponse &response) {
+        scopedCalls++;
+        return true;
+    }));
+    guarded.on("GET", "/api/admin/reboot", [&handlerCalls](HttpRequest &req) {
+        handlerCalls++;
+        return HubHttpResponse(200, "rebooting");
+    });
+    guarded.on("GET", "/api/status", [&handlerCalls](HttpRequest &req) {
+        handlerCalls++;
+        return HubHttpResponse(200, "fine");
+    });
+    guarded.begin();
+
+    out = exchange(guarded, "GET /api/admin/reboot HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "401") && contains(out, "denied"));
+    CHECK(handlerCalls == 0 && laterCalls == 0 && scopedCalls == 0);
+
+    out = exchange(guarded, "GET /api/admin/reboot HTTP/1.1\r\nAuthorization: yes\r\n\r\n");
+    CHECK(contains(out, "rebooting"));
+    CHECK(handlerCalls == 1 && laterCalls == 1 && scopedCalls == 1);
+
+    // Prefix-scoped middleware only runs for routes under its prefix
+    out = exchange(guarded, "GET /api/status HTTP/1.1\r\nAuthorization: yes\r\n\r\n");
+    CHECK(contains(out, "fine"));
+    CHECK(handlerCalls == 2 && laterCalls == 2 && scopedCalls == 1);
+
+    return testResult("test_middleware");
+}
@@ -0,0 +1,76 @@
+// Lazy query parsing: decoding, typed accessors, copy truncation and more than MAX_QUERY_PARAMS pairs
+#include "test_util.h"
+
+static std::string get(HttpServer &server, const std::string &target) {
+    return exchange(server, "GET " + target + " HTTP/1.1\r\n\r\n");
+}
+
+int main() {
+    HttpServer server;
+    server.setZeroCopyRequests(true);
+    String seen;
+    server.on("GET", "/q", [&seen](HttpRequest &req) {
+        seen = "";
+        // Percent-decoding and '+', in values and names
+        seen += "[" + req.getQueryParam("text") + "]";
+        seen += "[" + req.getQueryParam("a b") + "]";
+        seen += "[" + req.getQueryParam("missing", "dflt") + "]";
+        seen += req.hasQueryParam("flag") ? "[flag]" : "[noflag]";
+        seen += "[" + req.getQueryParamView("text").toString() + "]"; // raw
+        // Typed accessors
+        seen += "[" + String(req.getQueryParamInt("n", -1)) + "]";
+        seen += "[" + String(req.getQueryParamInt("neg", 0)) + "]";
+        seen += "[" + String(req.getQueryParamInt("bad", 7)) + "]";
+        seen += "[" + String(req.getQueryParamInt("missing", 9)) + "]";
+        seen += "[" + String(static_cast<long>(req.getQueryParamFloat("f", 0) * 100)) + "]";
+        seen += "[" + String(static_cast<long>(req.getQueryParamFloat("bad", 1.5f) * 10)) + "]";
+        seen += req.getQueryParamBool("flag") ? "[T]" : "[F]";
+        seen += req.getQueryParamBool("on") ? "[T]" : "[F]";
+        seen += req.getQueryParamBool("off", true) ? "[T]" : "[F]";
+        seen += req.getQueryParamBool("bad", true) ? "[T]" : "[F]";
+        seen += req.getQueryParamBool("missing") ? "[T]" : "[F]";
+        // copyQueryParam: full copy, truncation (NUL terminated, full length returned), missing
+        char buf[6];
+        int len = req.copyQueryParam("text", buf, sizeof(buf));
+        seen += "[" + String(len) + ":" + String(buf) + "]";
+        char big[32];
+        len = req.copyQueryParam("n", big, sizeof(big));
+        seen += "[" + String(len) + ":" + String(big) + "]";
+        seen += "[" + String(req.copyQueryParam("missing", big, sizeof(big))) + "]";
+        return HubHttpResponse(200, "ok");
+    });
+    String overflow;
+    server.on("GET", "/many", [&overflow](HttpRequest &req) {
+        overflow = req.getQueryParam("p3") + "," + req.getQueryParam("p17") + "," + req.getQueryParam("p19") + "," +
+                   String(req.getQueryParamInt("p18", -1)) + "," + (req.hasQueryParam("p20") ? "has" : "none") + ",";
+        req.materialize();
+        overflow += String(static_cast<unsigned long>(req.query.size())) + "," + req.query["p19"];
+        return HubHttpResponse(200, "ok");
+    });
+    server.begin();
+
+    get(server, "/q?text=h%C3%A9llo+w%6Frld%21&a%20b=c+d&flag&n=42&neg=-17&bad=4x&f=2.5&on=yes&off=off");
+    const char *expected = "[h\xC3\xA9llo world!][c d][dflt][flag][h%C3%A9llo+w%6Frld%21]"
+                           "[42][-17][7][9][250][15][T][T][F][T][F]"
+                           "[13:h\xC3\xA9ll][2:42][-1]";
+    CHECK(seen == expected);
+    if (seen != expected) {
+        printf("got %s\n", seen.c_str());
+    }
+
+    // Malformed escapes are kept as they are
+    get(server, "/q?text=100%25+%zz%4");
+    CHECK(contains(std::string(seen.c_str()), "[100% %zz%4]"));
+
+    // More pairs than the table holds: later ones are still found, and materialize() keeps them all
+    std::string target = "/many?";
+    for (int i = 1; i <= 19; i++) {
+        target += i == 18 ? "p18=188&" : "p" + std::to_string(i) + "=v" + std::to_string(i) + "&";
+    }
+    target.resize(target.size() - 1);
+    std::string out = get(server, target);
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(overflow == "v3,v17,v19,188,none,19,v19");
+
+    return testResult("test_query");
+}
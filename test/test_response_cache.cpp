@@ -0,0 +1,122 @@
+// Per-route response cache: TTL, vary keys, LRU budget, invalidation and bypasses
+#include "test_util.h"
+
+static int configCalls = 0;
+static int tempCalls = 0;
+static int itemCalls = 0;
+static int middlewareCalls = 0;
+
+static std::string get(HttpServer &server, const std::string &target, const std::string &headers = "") {
+    return exchange(server, "GET " + target + " HTTP/1.1\r\n" + headers + "\r\n");
+}
+
+int main() {
+    HttpServer server;
+    server.use(MiddlewareHandlerBool([](HttpRequest &req, HubHttpResponse &response) {
+        middlewareCalls++;
+        if (!req.getHeaderView("X-Block").empty()) {
+            response = HubHttpResponse(401, "blocked");
+            return false;
+        }
+        return true;
+    }));
+    server.on("GET", "/api/config", [](HttpRequest &req) {
+        configCalls++;
+        return HubHttpResponse(200, "config " + String(configCalls));
+    });
+    server.on("GET", "/api/temp", [](HttpRequest &req) {
+        tempCalls++;
+        return HubHttpResponse(200, "temp " + req.getQueryParam("unit") + " " + req.getHeader("Accept-Language"));
+    });
+    server.on("GET", "/items/:id", [](HttpRequest &req) {
+        itemCalls++;
+        return HubHttpResponse(200, String(std::string(300, 'i').c_str()) + req.getParam("id"));
+    });
+    ResponseCachePolicy oneSecond;
+    oneSecond.ttl = 1000;
+    CHECK(server.setResponseCache("GET", "/api/config", oneSecond));
+    ResponseCachePolicy vary;
+    vary.ttl = 1000;
+    vary.varyQuery.push_back("unit");
+    vary.varyHeaders.push_back("Accept-Language");
+    CHECK(server.setResponseCache("GET", "/api/temp", vary));
+    ResponseCachePolicy items;
+    items.ttl = 60000;
+    CHECK(server.setResponseCache("GET", "/items/:id", items));
+    CHECK(!server.setResponseCache("GET", "/not/registered", items));
+    server.begin();
+
+    // TTL: a hit within it is byte-identical and skips the handler, expiry calls it again
+    std::string first = get(server, "/api/config");
+    CHECK(contains(first, "config 1"));
+    shimAdvanceMillis(500);
+    CHECK(get(server, "/api/config") == first);
+    CHECK(configCalls == 1);
+    CHECK(server.getResponseCacheHits() == 1);
+    shimAdvanceMillis(600);
+    CHECK(contains(get(server, "/api/config"), "config 2"));
+    CHECK(configCalls == 2);
+
+    // Middleware still runs on every request, hits included, and can refuse one
+    int before = middlewareCalls;
+    CHECK(contains(get(server, "/api/config"), "config 2"));
+    CHECK(middlewareCalls == before + 1);
+    std::string blocked = get(server, "/api/config", "X-Block: 1\r\n");
+    CHECK(contains(blocked, "HTTP/1.1 401"));
+    CHECK(!contains(blocked, "config"));
+    CHECK(configCalls == 2);
+
+    // If-None-Match always reaches the handler (it may answer 304)
+    get(server, "/api/config", "If-None-Match: \"abc\"\r\n");
+    CHECK(configCalls == 3);
+
+    // varyQuery / varyHeaders select entries, other query parameters do not
+    CHECK(contains(get(server, "/api/temp?unit=c", "Accept-Language: de\r\n"), "temp c de"));
+    CHECK(contains(get(server, "/api/temp?unit=f", "Accept-Language: de\r\n"), "temp f de"));
+    CHECK(contains(get(server, "/api/temp?unit=c", "Accept-Language: en\r\n"), "temp c en"));
+    CHECK(tempCalls == 3);
+    CHECK(contains(get(server, "/api/temp?unit=c&debug=1", "Accept-Language: de\r\n"), "temp c de"));
+    CHECK(contains(get(server, "/api/temp?unit=f", "Accept-Language: de\r\n"), "temp f de"));
+    CHECK(tempCalls == 3);
+
+    // Explicit invalidation of one route leaves the others cached
+    CHECK(server.invalidateResponseCache("GET", "/api/temp"));
+    CHECK(!server.invalidateResponseCache("GET", "/not/registered"));
+    get(server, "/api/temp?unit=f", "Accept-Language: de\r\n");
+    CHECK(tempCalls == 4);
+    get(server, "/api/config");
+    CHECK(configCalls == 3);
+
+    // LRU eviction within the budget: room for two item entries
+    server.invalidateResponseCache();
+    CHECK(server.getResponseCacheSize() == 0);
+    get(server, "/items/1");
+    size_t entrySize = server.getResponseCacheSize();
+    CHECK(entrySize > 300);
+    server.setResponseCacheBudget(entrySize * 2 + entrySize / 2);
+    get(server, "/items/2");
+    CHECK(itemCalls == 2);
+    get(server, "/items/1"); // 1 is now more recently used than 2
+    CHECK(itemCalls == 2);
+    get(server, "/items/3"); // evicts 2
+    CHECK(itemCalls == 3);
+    CHECK(server.getResponseCacheSize() <= entrySize * 2 + entrySize / 2);
+    get(server, "/items/1");
+    get(server, "/items/3");
+    CHECK(itemCalls == 3);
+    get(server, "/items/2");
+    CHECK(itemCalls == 4);
+
+    // Shrinking the budget evicts right away; a response bigger than the budget is never stored
+    server.setResponseCacheBudget(entrySize);
+    CHECK(server.getResponseCacheSize() <= entrySize);
+    server.setResponseCacheBudget(entrySize / 2);
+    CHECK(server.getResponseCacheSize() == 0);
+    std::string uncached = get(server, "/items/9");
+    CHECK(contains(uncached, std::string(300, 'i') + "9"));
+    CHECK(server.getResponseCacheSize() == 0);
+    get(server, "/items/9");
+    CHECK(itemCalls == 6);
+
+    return testResult("test_response_cache");
+}
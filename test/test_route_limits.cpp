@@ -0,0 +1,92 @@
+// Per-route limits: 413 for large bodies, 431 for too many headers, 408 past the read deadline
+#include "test_util.h"
+
+static std::string headerLines(int count) {
+    std::string lines;
+    for (int i = 0; i < count; i++) {
+        lines += "X-H" + std::to_string(i) + ": v\r\n";
+    }
+    return lines;
+}
+
+int main() {
+    HttpServer server;
+    int driveCalls = 0;
+    server.on("POST", "/drive", [&driveCalls](HttpRequest &req) {
+        driveCalls++;
+        return HubHttpResponse(200, "drive " + req.body);
+    });
+    server.on("POST", "/upload", [](HttpRequest &req) {
+        return HubHttpResponse(200, "len=" + String(static_cast<unsigned long>(req.body.length())));
+    });
+    server.on("GET", "/plain", [](HttpRequest &req) {
+        return HubHttpResponse(200, "plain");
+    });
+    RouteLimits drive;
+    drive.maxBodySize = 16;
+    drive.maxHeaders = 3;
+    drive.readDeadline = 500;
+    CHECK(server.setRouteLimits("POST", "/drive", drive));
+    RouteLimits upload;
+    upload.readDeadline = 120000; // longer than a uint16_t holds
+    CHECK(server.setRouteLimits("POST", "/upload", upload));
+    CHECK(!server.setRouteLimits("POST", "/nowhere", drive));
+    server.begin();
+
+    std::string out = exchange(server, "POST /drive HTTP/1.1\r\nContent-Length: 4\r\n\r\nfast");
+    CHECK(contains(out, "drive fast"));
+
+    // 413 from the Content-Length alone, before any of the body is sent
+    std::shared_ptr<MockSocket> socket = connectClient("POST /drive HTTP/1.1\r\nContent-Length: 1000\r\n\r\n");
+    runTicks(server, 2);
+    CHECK(contains(socket->sent, "HTTP/1.1 413"));
+    CHECK(!socket->open);
+    // ... and for a chunked body once the decoded size passes the limit
+    out = exchange(server, "POST /drive HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                           "10\r\n0123456789abcdef\r\n4\r\nmore\r\n0\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 413"));
+    CHECK(driveCalls == 1);
+
+    // 431: above the route's own limit, and above the parser's MAX_HEADERS on any route
+    out = exchange(server, "POST /drive HTTP/1.1\r\nContent-Length: 0\r\n" + headerLines(3) + "\r\n");
+    CHECK(contains(out, "HTTP/1.1 431"));
+    out = exchange(server, "GET /plain HTTP/1.1\r\n" + headerLines(HttpServer::MAX_HEADERS) + "\r\n");
+    CHECK(contains(out, "\r\n\r\nplain"));
+    out = exchange(server, "GET /plain HTTP/1.1\r\n" + headerLines(HttpServer::MAX_HEADERS + 1) + "\r\n");
+    CHECK(contains(out, "HTTP/1.1 431"));
+    CHECK(!contains(out, "\r\n\r\nplain"));
+    out = exchange(server, "GET /plain HTTP/1.1\r\nbad header\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 400"));
+    CHECK(driveCalls == 1);
+
+    // 408 once the route's deadline passes, even though bytes keep trickling in
+    socket = connectClient("POST /drive HTTP/1.1\r\nContent-Length: 8\r\n\r\nab");
+    server.tick();
+    shimAdvanceMillis(300);
+    socket->received += "cd";
+    server.tick();
+    CHECK(socket->sent.empty());
+    shimAdvanceMillis(300);
+    socket->received += "ef";
+    server.tick();
+    CHECK(contains(socket->sent, "HTTP/1.1 408"));
+    CHECK(driveCalls == 1);
+    socket->open = false;
+    server.tick();
+
+    // A deadline beyond 65 s: a slow upload that keeps sending finishes after 70 s
+    socket = connectClient("POST /upload HTTP/1.1\r\nContent-Length: 70\r\n\r\n");
+    server.tick();
+    for (int second = 0; second < 70; second++) {
+        shimAdvanceMillis(1000);
+        socket->received += "u";
+        server.tick();
+    }
+    runTicks(server, 2);
+    CHECK(contains(socket->sent, "len=70"));
+    CHECK(!contains(socket->sent, "408"));
+    socket->open = false;
+    server.tick();
+
+    return testResult("test_route_limits");
+}
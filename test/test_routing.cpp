@@ -0,0 +1,190 @@
+// Route resolution: precedence between static, :param and wildcard routes, method dispatch
+// (405 / Allow, HEAD via GET), and each request resolved once and reused by the body handler
+// and dispatch
+#include "test_util.h"
+#include <http_static_router.h>
+
+static const char STATIC_ITEM[] = "/static/:id";
+
+static void getStaticItem(HttpRequest &req, HubHttpResponse &response, void *) {
+    response.setStatus(200);
+    response.setBody("static " + req.getParam("id"));
+}
+
+typedef StaticRouter<
+    StaticRoute<HTTP_METHOD_GET, STATIC_ITEM, getStaticItem>
+> TestRoutes;
+
+static std::string bodyOf(const std::string &response) {
+    size_t headEnd = response.find("\r\n\r\n");
+    return headEnd == std::string::npos ? std::string() : response.substr(headEnd + 4);
+}
+
+static std::string request(HttpServer &server, const std::string &method, const std::string &path) {
+    return bodyOf(exchange(server, method + " " + path + " HTTP/1.1\r\nContent-Length: 0\r\n\r\n"));
+}
+
+// Static beats :param beats a trailing wildcard, per segment; a method route beats an any-method route
+static void testPrecedence() {
+    HttpServer server;
+    server.on("GET", "/files/readme", [](HttpRequest &req) {
+        return HubHttpResponse(200, "static");
+    });
+    server.on("GET", "/files/:name", [](HttpRequest &req) {
+        return HubHttpResponse(200, "param " + req.getParam("name"));
+    });
+    server.on("GET", "/files/:name/meta", [](HttpRequest &req) {
+        return HubHttpResponse(200, "meta " + req.getParam("name"));
+    });
+    server.on("GET", "/files/*", [](HttpRequest &req) {
+        return HubHttpResponse(200, "wild [" + req.getRemainingPath() + "]");
+    });
+    server.on("GET", "/static/*", [](HttpRequest &req) {
+        return HubHttpResponse(200, "assets [" + req.getRemainingPath() + "]");
+    });
+    server.on("/dev/status", [](HttpRequest &req) {
+        return HubHttpResponse(200, "any");
+    });
+    server.on("GET", "/dev/status", [](HttpRequest &req) {
+        return HubHttpResponse(200, "get");
+    });
+    server.mount("/api/v1", [](HttpRequest &req) {
+        return HubHttpResponse(200, "mount [" + req.getRemainingPath() + "]");
+    });
+    server.on("GET", "/api/v1/health", [](HttpRequest &req) {
+        return HubHttpResponse(200, "health");
+    });
+    server.begin();
+
+    CHECK(request(server, "GET", "/files/readme") == "static");
+    CHECK(request(server, "GET", "/files/notes") == "param notes");
+    CHECK(request(server, "GET", "/files/readme/meta") == "meta readme"); // the static branch has no "meta"
+    CHECK(request(server, "GET", "/files/a/b/c") == "wild [a/b/c]");
+    CHECK(request(server, "GET", "/files") == "wild []");
+
+    // A wildcard matches its own prefix, with nothing remaining
+    CHECK(request(server, "GET", "/static") == "assets []");
+    CHECK(request(server, "GET", "/static/css/app.css") == "assets [css/app.css]");
+
+    CHECK(request(server, "GET", "/dev/status") == "get");
+    CHECK(request(server, "POST", "/dev/status") == "any");
+    CHECK(request(server, "HEAD", "/dev/status").empty());
+
+    // mount(): any method below the prefix, more specific routes under it still win
+    CHECK(request(server, "GET", "/api/v1/robots/7") == "mount [robots/7]");
+    CHECK(request(server, "DELETE", "/api/v1/robots/7") == "mount [robots/7]");
+    CHECK(request(server, "GET", "/api/v1") == "mount []");
+    CHECK(request(server, "GET", "/api/v1/health") == "health");
+    CHECK(request(server, "POST", "/api/v1/health") == "mount [health]");
+
+    // Empty segments are skipped; a wildcard's rest keeps the request's own slashes
+    CHECK(request(server, "GET", "//files///notes") == "param notes");
+    CHECK(request(server, "GET", "/files/readme/") == "static");
+    CHECK(request(server, "GET", "/static//css//app.css") == "assets [css//app.css]");
+}
+
+// 405 with an Allow header for wrong-verb requests, and HEAD answered by GET routes
+static void testMethods() {
+    HttpServer server;
+    server.on("GET", "/status", [](HttpRequest &req) {
+        return HubHttpResponse(200, "status body");
+    });
+    server.on("PUT", "/status", [](HttpRequest &req) {
+        return HubHttpResponse(200, "stored");
+    });
+    server.on("POST", "/upload", [](HttpRequest &req) {
+        return HubHttpResponse(200, "uploaded");
+    });
+    server.on("HEAD", "/probe", [](HttpRequest &req) {
+        return HubHttpResponse(200, "probe body");
+    });
+    server.on("GET", "/probe", [](HttpRequest &req) {
+        return HubHttpResponse(200, "get probe");
+    });
+    server.begin();
+
+    std::string out = exchange(server, "DELETE /status HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 405"));
+    CHECK(contains(out, "Allow: GET, HEAD, PUT\r\n"));
+    out = exchange(server, "DELETE /status HTTP/1.1\r\n\r\n"); // from the route cache this time
+    CHECK(contains(out, "Allow: GET, HEAD, PUT\r\n"));
+    out = exchange(server, "GET /upload HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 405"));
+    CHECK(contains(out, "Allow: POST\r\n"));
+    out = exchange(server, "GET /nowhere HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 404"));
+
+    // HEAD on a GET route: the GET response's headers, no body
+    out = exchange(server, "HEAD /status HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(contains(out, "Content-Length: 11\r\n"));
+    CHECK(out.size() >= 4 && out.compare(out.size() - 4, 4, "\r\n\r\n") == 0);
+    CHECK(!contains(out, "status body"));
+    // An explicit HEAD route wins over the GET route, and its body is dropped as well
+    out = exchange(server, "HEAD /probe HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "Content-Length: 10\r\n"));
+    CHECK(!contains(out, "probe body"));
+    // HEAD where only POST is routed is still a 405
+    out = exchange(server, "HEAD /upload HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 405"));
+}
+
+int main() {
+    testPrecedence();
+    testMethods();
+
+    HttpServer server;
+    server.setKeepAlive(true);
+    server.setRouteCacheEnabled(true);
+    server.useStaticRoutes<TestRoutes>();
+    server.on("GET", "/items/:id", [](HttpRequest &req) {
+        return HubHttpResponse(200, "item " + req.getParam("id"));
+    });
+    String uploadedTo;
+    String uploaded;
+    server.onUpload("POST", "/files/:name", [&](HttpRequest &req, const uint8_t *data, size_t length) {
+        uploadedTo += req.getParam("name") + ";";
+        uploaded.concat(reinterpret_cast<const char*>(data), length);
+        return true;
+    }, [&](HttpRequest &req) {
+        return HubHttpResponse(200, req.getParam("name") + "=" + uploaded);
+    });
+    server.begin();
+
+    // One router lookup per request - the cache counts each request once
+    std::string out = exchange(server,
+                               "GET /items/1 HTTP/1.1\r\n\r\n"
+                               "GET /items/2 HTTP/1.1\r\n\r\n"
+                               "GET /items/1 HTTP/1.1\r\n\r\n"
+                               "GET /missing HTTP/1.1\r\n\r\n"
+                               "GET /missing HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "item 1"));
+    CHECK(contains(out, "item 2"));
+    CHECK(contains(out, "404"));
+    // A path without a route is cached as well, so a client polling it skips the tree
+    CHECK(server.getRouteCacheHits() == 2);
+    CHECK(server.getRouteCacheMisses() == 3);
+
+    // Compile-time routes never reach the router
+    out = exchange(server, "GET /static/7 HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "static 7"));
+    out = exchange(server, "HEAD /static/7 HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(!contains(out, "static 7"));
+    CHECK(server.getRouteCacheHits() + server.getRouteCacheMisses() == 5);
+
+    // A streamed upload keeps its path params on every tick the body arrives on
+    std::shared_ptr<MockSocket> socket = connectClient("POST /files/log.txt HTTP/1.1\r\nContent-Length: 6\r\n\r\nab");
+    server.tick();
+    socket->received += "cd";
+    server.tick();
+    socket->received += "ef";
+    runTicks(server, 3);
+    CHECK(contains(socket->sent, "log.txt=abcdef"));
+    CHECK(uploadedTo == "log.txt;log.txt;log.txt;");
+    CHECK(server.getRouteCacheHits() + server.getRouteCacheMisses() == 6);
+    socket->open = false;
+    server.tick();
+
+    return testResult("test_routing");
+}
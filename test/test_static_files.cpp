@@ -0,0 +1,91 @@
+// serveStatic() over a filesystem and an embedded table: gzip siblings and index.html are
+// found without failed opens, and HEAD gets the headers without the body
+#include "test_util.h"
+#include <cstdlib>
+#include <unistd.h>
+
+static std::string root;
+
+static void writeFile(const std::string &path, const std::string &content) {
+    FILE *file = fopen((root + path).c_str(), "wb");
+    fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+}
+
+int main() {
+    char dir[] = "/tmp/hub_http_static_XXXXXX";
+    root = mkdtemp(dir);
+    mkdir((root + "/www").c_str(), 0700);
+    mkdir((root + "/www/docs").c_str(), 0700);
+    writeFile("/www/index.html", "<h1>home</h1>");
+    writeFile("/www/app.js", "plain js");
+    writeFile("/www/app.js.gz", "gzipped js");
+    writeFile("/www/only.css.gz", "gzipped css");
+    writeFile("/www/docs/index.html", "<h1>docs</h1>");
+
+    fs::FS fs(root);
+    static const uint8_t LOGO[] = "svg-bytes";
+    static const HttpEmbeddedFile EMBEDDED[] = {
+        { "/logo.svg", LOGO, sizeof(LOGO) - 1, nullptr },
+    };
+    HttpServer server;
+    server.serveStatic("/ui", fs, "/www");
+    server.serveStatic("/blob", EMBEDDED, 1);
+    server.begin();
+
+    std::string out = exchange(server, "GET /ui/app.js HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "\r\n\r\nplain js"));
+    CHECK(contains(out, "Vary: Accept-Encoding"));
+    out = exchange(server, "GET /ui/app.js HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n");
+    CHECK(contains(out, "Content-Encoding: gzip"));
+    CHECK(contains(out, "\r\n\r\ngzipped js"));
+    out = exchange(server, "GET /ui/docs HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "<h1>docs</h1>"));
+    out = exchange(server, "GET /ui/only.css HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 406"));
+    out = exchange(server, "GET /ui/only.css HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n");
+    CHECK(contains(out, "gzipped css"));
+    out = exchange(server, "GET /ui/missing.js HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 404"));
+
+    // HEAD (browsers and proxies revalidating assets) - the GET headers, no body
+    out = exchange(server, "HEAD /ui/app.js HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(contains(out, "Content-Length: 8\r\n"));
+    CHECK(contains(out, "ETag: "));
+    CHECK(!contains(out, "plain js"));
+    out = exchange(server, "HEAD /blob/logo.svg HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 200"));
+    CHECK(contains(out, "Content-Type: image/svg+xml"));
+    CHECK(contains(out, "Content-Length: 9\r\n"));
+    CHECK(!contains(out, "svg-bytes"));
+    out = exchange(server, "GET /blob/logo.svg HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "\r\n\r\nsvg-bytes"));
+
+    // Revalidating with the ETag a file was served with gets a 304 without the file
+    out = exchange(server, "GET /ui/app.js HTTP/1.1\r\n\r\n");
+    size_t tagStart = out.find("ETag: ") + 6;
+    std::string tag = out.substr(tagStart, out.find("\r\n", tagStart) - tagStart);
+    out = exchange(server, "GET /ui/app.js HTTP/1.1\r\nIf-None-Match: " + tag + "\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 304"));
+    CHECK(!contains(out, "plain js"));
+    out = exchange(server, "GET /blob/logo.svg HTTP/1.1\r\n\r\n");
+    tagStart = out.find("ETag: ") + 6;
+    tag = out.substr(tagStart, out.find("\r\n", tagStart) - tagStart);
+    out = exchange(server, "GET /blob/logo.svg HTTP/1.1\r\nIf-None-Match: " + tag + "\r\n\r\n");
+    CHECK(contains(out, "HTTP/1.1 304"));
+    CHECK(!contains(out, "svg-bytes"));
+
+    // Every open() was for a file that exists (a failed one logs an error on the ESP32)
+    CHECK(fs.opens > 0);
+    CHECK(fs.failedOpens == 0);
+
+    const char *files[] = { "/www/index.html", "/www/app.js", "/www/app.js.gz", "/www/only.css.gz", "/www/docs/index.html" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        unlink((root + files[i]).c_str());
+    }
+    rmdir((root + "/www/docs").c_str());
+    rmdir((root + "/www").c_str());
+    rmdir(root.c_str());
+    return testResult("test_static_files");
+}
@@ -0,0 +1,138 @@
+// Generator bodies: chunked framing, known lengths, generators that stop early and slow readers
+#include "test_util.h"
+
+static std::string pattern(size_t length) {
+    std::string s;
+    for (size_t i = 0; i < length; i++) {
+        s += static_cast<char>('a' + i % 26);
+    }
+    return s;
+}
+
+// A generator handing out `body` piece by piece, counting its calls
+static BodyGenerator generatorFor(const std::string &body, size_t stopAfter, int *calls) {
+    std::shared_ptr<size_t> offset(new size_t(0));
+    return [body, stopAfter, calls, offset](uint8_t *buffer, size_t maxLength) -> size_t {
+        (*calls)++;
+        size_t end = std::min(body.size(), stopAfter);
+        size_t n = std::min(maxLength, end - *offset);
+        memcpy(buffer, body.data() + *offset, n);
+        *offset += n;
+        return n;
+    };
+}
+
+// Decode a chunked body, recording each chunk's size; false if the framing is broken
+static bool decodeChunked(const std::string &raw, std::string &body, std::vector<size_t> &sizes, size_t &used) {
+    size_t p = 0;
+    while (true) {
+        size_t lineEnd = raw.find("\r\n", p);
+        if (lineEnd == std::string::npos) return false;
+        size_t size = strtoul(raw.substr(p, lineEnd - p).c_str(), nullptr, 16);
+        p = lineEnd + 2;
+        if (size == 0) {
+            if (raw.compare(p, 2, "\r\n") != 0) return false;
+            used = p + 2;
+            return true;
+        }
+        if (raw.size() < p + size + 2 || raw.compare(p + size, 2, "\r\n") != 0) return false;
+        sizes.push_back(size);
+        body += raw.substr(p, size);
+        p += size + 2;
+    }
+}
+
+static std::string bodyOf(const std::string &response) {
+    return response.substr(response.find("\r\n\r\n") + 4);
+}
+
+int main() {
+    const std::string big = pattern(2500);
+    int calls = 0;
+    HttpServer server;
+    server.setKeepAlive(true);
+    server.on("GET", "/chunked", [&](HttpRequest &req) {
+        HubHttpResponse response;
+        response.stream("text/plain", generatorFor(big, SIZE_MAX, &calls));
+        return response;
+    });
+    server.on("GET", "/sized", [&](HttpRequest &req) {
+        HubHttpResponse response;
+        response.stream("text/plain", generatorFor(big, SIZE_MAX, &calls), static_cast<int32_t>(big.size()));
+        return response;
+    });
+    server.on("GET", "/short", [&](HttpRequest &req) {
+        HubHttpResponse response;
+        response.stream("text/plain", generatorFor(big, 1000, &calls), static_cast<int32_t>(big.size()));
+        return response;
+    });
+    server.on("GET", "/empty", [&](HttpRequest &req) {
+        HubHttpResponse response;
+        response.stream("text/plain", generatorFor("", SIZE_MAX, &calls));
+        return response;
+    });
+    server.on("GET", "/next", [](HttpRequest &req) {
+        return HubHttpResponse(200, "next");
+    });
+    server.begin();
+
+    // Unknown length: STREAM_CHUNK_SIZE chunks, then the terminating 0\r\n\r\n; the connection stays usable
+    std::shared_ptr<MockSocket> socket = connectClient("GET /chunked HTTP/1.1\r\n\r\nGET /next HTTP/1.1\r\n\r\n");
+    runTicks(server);
+    CHECK(contains(socket->sent, "Transfer-Encoding: chunked\r\n"));
+    CHECK(!contains(socket->sent.substr(0, socket->sent.find("\r\n\r\n")), "Content-Length"));
+    std::string body;
+    std::vector<size_t> sizes;
+    size_t used = 0;
+    std::string raw = bodyOf(socket->sent);
+    CHECK(decodeChunked(raw, body, sizes, used));
+    CHECK(body == big);
+    CHECK(sizes.size() == 3);
+    CHECK(sizes.size() == 3 && sizes[0] == HttpServer::STREAM_CHUNK_SIZE && sizes[1] == HttpServer::STREAM_CHUNK_SIZE &&
+          sizes[2] == big.size() - 2 * HttpServer::STREAM_CHUNK_SIZE);
+    CHECK(raw.compare(used - 5, 5, "0\r\n\r\n") == 0);
+    CHECK(raw.compare(used, 17, "HTTP/1.1 200 OK\r\n") == 0);
+    CHECK(contains(raw.substr(used), "next"));
+    socket->open = false;
+    server.tick();
+
+    // An empty chunked body is just the terminator
+    std::string out = exchange(server, "GET /empty HTTP/1.1\r\n\r\n");
+    CHECK(bodyOf(out) == "0\r\n\r\n");
+
+    // Known length: Content-Length and the raw bytes, no framing
+    out = exchange(server, "GET /sized HTTP/1.1\r\n\r\nGET /next HTTP/1.1\r\n\r\n");
+    CHECK(contains(out, "Content-Length: 2500\r\n"));
+    CHECK(!contains(out, "Transfer-Encoding"));
+    CHECK(bodyOf(out).compare(0, big.size(), big) == 0);
+    CHECK(contains(out, "next"));
+
+    // A generator that stops short of its Content-Length: the client can only tell from a close
+    socket = connectClient("GET /short HTTP/1.1\r\n\r\nGET /next HTTP/1.1\r\n\r\n");
+    runTicks(server);
+    CHECK(contains(socket->sent, "Content-Length: 2500\r\n"));
+    CHECK(bodyOf(socket->sent) == big.substr(0, 1000));
+    CHECK(!socket->open);
+
+    // A slow reader: the generator runs only as the socket frees space, never far ahead of it
+    socket = connectClient("GET /chunked HTTP/1.1\r\n\r\n");
+    socket->writeSpace = 300;
+    calls = 0;
+    server.tick();
+    CHECK(calls == 1); // one chunk produced, most of it still waiting
+    int ticks = 0;
+    while (!contains(socket->sent, "0\r\n\r\n") && ticks++ < 100) {
+        socket->writeSpace = 300;
+        server.tick();
+        CHECK(calls <= 1 + static_cast<int>(socket->sent.size() / HttpServer::STREAM_CHUNK_SIZE) + 1);
+    }
+    body.clear();
+    sizes.clear();
+    CHECK(decodeChunked(bodyOf(socket->sent), body, sizes, used));
+    CHECK(body == big);
+    CHECK(ticks > 5);
+    socket->open = false;
+    server.tick();
+
+    return testResult("test_streaming");
+}
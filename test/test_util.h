@@ -0,0 +1,60 @@
+// Helpers shared by the host tests
+#pragma once
+
+#include <http_server.h>
+#include <cstdio>
+#include <string>
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);         \
+            testFailures++;                                                         \
+        }                                                                           \
+    } while (0)
+
+// Accept a new client connection that has already sent `received`
+inline std::shared_ptr<MockSocket> connectClient(const std::string &received) {
+    std::shared_ptr<MockSocket> socket(new MockSocket());
+    socket->received = received;
+    WiFiServer::pending.push_back(WiFiClient(socket));
+    return socket;
+}
+
+inline void runTicks(HttpServer &server, int ticks = 10) {
+    for (int i = 0; i < ticks; i++) {
+        server.tick();
+    }
+}
+
+// Send raw request bytes on a new connection and return everything the server wrote
+inline std::string exchange(HttpServer &server, const std::string &request, int ticks = 10) {
+    std::shared_ptr<MockSocket> socket = connectClient(request);
+    runTicks(server, ticks);
+    socket->open = false;
+    server.tick(); // let the server drop the connection
+    return socket->sent;
+}
+
+inline bool contains(const std::string &s, const std::string &part) {
+    return s.find(part) != std::string::npos;
+}
+
+inline size_t countOf(const std::string &s, const std::string &part) {
+    size_t n = 0;
+    for (size_t p = s.find(part); p != std::string::npos; p = s.find(part, p + part.size())) {
+        n++;
+    }
+    return n;
+}
+
+inline int testResult(const char *name) {
+    if (testFailures == 0) {
+        printf("%s: ok\n", name);
+    } else {
+        printf("%s: %d check(s) failed\n", name, testFailures);
+    }
+    return testFailures == 0 ? 0 : 1;
+}
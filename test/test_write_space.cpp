@@ -0,0 +1,49 @@
+// Responses still go out on clients whose availableForWrite() is Print's default of 0
+#include "test_util.h"
+
+int main() {
+    HttpServer server;
+    server.setKeepAlive(true);
+    server.on("GET", "/small", [](HttpRequest &req) {
+        return HubHttpResponse(200, "small");
+    });
+    std::string big(20000, 'b');
+    big += "end";
+    server.on("GET", "/big", [&big](HttpRequest &req) {
+        return HubHttpResponse(200, String(big.c_str()));
+    });
+    server.begin();
+
+    // Small response: one write, sent in the tick that handled the request
+    std::shared_ptr<MockSocket> socket = connectClient("GET /small HTTP/1.1\r\n\r\n");
+    socket->reportsWriteSpace = false;
+    server.tick();
+    CHECK(contains(socket->sent, "HTTP/1.1 200"));
+    CHECK(contains(socket->sent, "\r\n\r\nsmall"));
+    CHECK(socket->writes == 1);
+
+    // Large response: offered a segment at a time, complete and in order
+    socket->sent.clear();
+    socket->writes = 0;
+    socket->received = "GET /big HTTP/1.1\r\n\r\nGET /small HTTP/1.1\r\n\r\n";
+    runTicks(server, 40);
+    size_t bodyStart = socket->sent.find("\r\n\r\n") + 4;
+    CHECK(socket->sent.compare(bodyStart, big.size(), big) == 0);
+    CHECK(countOf(socket->sent, "HTTP/1.1 200") == 2);
+    CHECK(contains(socket->sent, "\r\n\r\nsmall"));
+    CHECK(socket->writes >= static_cast<int>(big.size() / HttpServer::SEND_BUFFER_SIZE));
+
+    // A socket that takes nothing leaves the output queued until it does
+    socket->sent.clear();
+    socket->maxWrite = 0;
+    socket->received = "GET /small HTTP/1.1\r\n\r\n";
+    runTicks(server, 3);
+    CHECK(socket->sent.empty());
+    socket->maxWrite = SIZE_MAX;
+    runTicks(server, 3);
+    CHECK(contains(socket->sent, "\r\n\r\nsmall"));
+
+    socket->open = false;
+    server.tick();
+    return testResult("test_write_space");
+}